@@ -0,0 +1,337 @@
+#include "AssetLoader.hpp"
+#include "Utils.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	// The same TTF baked at two sizes is two different bitmaps.
+	static std::string MakeFontKey(const std::string& path, float pixelHeight) {
+		return path + "@" + std::to_string(pixelHeight);
+	}
+
+	AssetLoader::AssetLoader(JobSystem& jobs, const AssetFileSystem& fileSystem) : jobs(jobs), fileSystem(fileSystem) { }
+
+	AssetLoader::~AssetLoader() {
+		// Loads still in flight write into the entries, let them land first.
+		jobs.Wait(tasks);
+		Destroy(files);
+		Destroy(meshes);
+		Destroy(fonts);
+	}
+
+	//
+	// Prefetch
+	//
+
+	void AssetLoader::PrefetchFile(const std::string& path) {
+		Prefetch(files, path, [this](const std::string& path, AssetFile& file) {
+			OpenFile(path, file);
+		});
+	}
+
+	void AssetLoader::PrefetchMesh(const std::string& path) {
+		Prefetch(meshes, path, [this](const std::string& path, MeshData& mesh) {
+			LoadMesh(path, mesh);
+		});
+	}
+
+	void AssetLoader::PrefetchFont(const std::string& path, float pixelHeight) {
+		Prefetch(fonts, MakeFontKey(path, pixelHeight), [this, path, pixelHeight](const std::string&, FontBitmap& font) {
+			BakeFont(path, pixelHeight, font);
+		});
+	}
+
+	void AssetLoader::Run(JobFunction function) {
+		jobs.Submit([this, function]() {
+			try {
+				function();
+			}
+			catch(...) {
+				std::lock_guard<std::mutex> lock(taskErrorMutex);
+				if(!taskError) taskError = std::current_exception();
+			}
+		}, &tasks);
+	}
+
+	void AssetLoader::Wait() {
+		PROFILE_SCOPE("Wait for assets");
+		jobs.Wait(tasks);
+
+		std::lock_guard<std::mutex> lock(taskErrorMutex);
+		if(taskError) std::rethrow_exception(taskError);
+	}
+
+	//
+	// Access
+	//
+
+	const AssetFile& AssetLoader::GetFile(const std::string& path) {
+		return Get(Prefetch(files, path, [this](const std::string& path, AssetFile& file) {
+			OpenFile(path, file);
+		}));
+	}
+
+	const MeshData& AssetLoader::GetMesh(const std::string& path) {
+		return Get(Prefetch(meshes, path, [this](const std::string& path, MeshData& mesh) {
+			LoadMesh(path, mesh);
+		}));
+	}
+
+	const FontBitmap& AssetLoader::GetFont(const std::string& path, float pixelHeight) {
+		return Get(Prefetch(fonts, MakeFontKey(path, pixelHeight), [this, path, pixelHeight](const std::string&, FontBitmap& font) {
+			BakeFont(path, pixelHeight, font);
+		}));
+	}
+
+	template <typename T, typename LoadFunction>
+	AssetLoader::Entry<T>* AssetLoader::Prefetch(EntryTable<T>& table, const std::string& path, LoadFunction load) {
+		// Submitting under the lock makes sure nobody can find the entry
+		// before its counter is raised.
+		std::lock_guard<std::mutex> lock(tableMutex);
+
+		auto it = table.find(path);
+		if(it != table.end()) return it->second;
+
+		auto* entry = new Entry<T>();
+		table[path] = entry;
+
+		// Entries get their own counter for Get() and join the shared one so
+		// Wait() and the destructor cover them too.
+		entry->ready.value.fetch_add(1, std::memory_order_relaxed);
+		jobs.Submit([entry, path, load]() {
+			DebugLog("Loading asset: " + path);
+			try {
+				load(path, entry->data);
+			}
+			catch(...) {
+				entry->error = std::current_exception();
+			}
+			entry->ready.value.fetch_sub(1, std::memory_order_release);
+		}, &tasks);
+
+		return entry;
+	}
+
+	template <typename T>
+	const T& AssetLoader::Get(Entry<T>* entry) {
+		jobs.Wait(entry->ready);
+		if(entry->error) std::rethrow_exception(entry->error);
+		return entry->data;
+	}
+
+	template <typename T>
+	void AssetLoader::Destroy(EntryTable<T>& table) {
+		for(auto& kv : table) delete kv.second;
+		table.clear();
+	}
+
+	//
+	// Loaders (run on job threads)
+	//
+
+	void AssetLoader::OpenFile(const std::string& path, AssetFile& file) const {
+		if(!fileSystem.Open(path, file)) throw std::runtime_error("Failed to open file: " + path);
+	}
+
+	void AssetLoader::LoadMesh(const std::string& path, MeshData& mesh) const {
+		PROFILE_SCOPE("Load mesh");
+		const std::string objPath = path.substr(0, path.find_last_of('.')) + ".obj";
+		if(OpenMeshFile(fileSystem, path, mesh)) {
+			// Packed meshes are used as built. A loose one is only as fresh
+			// as the OBJ next to it, if that is still around.
+			uint64_t sourceHash;
+			if(!mesh.file.IsLoose() || !HashMeshSource(objPath, sourceHash) || sourceHash == mesh.sourceHash) return;
+
+			// Unmapped first, the converter replaces the file in place.
+			DebugLog("Mesh file is older than its OBJ: " + path);
+			mesh.file.Close();
+		}
+
+		// Not packed and no usable loose .pmesh yet, build it from the OBJ
+		// next to it (the same thing --convert-mesh does offline).
+		DebugLog("Converting " + objPath + " to " + path);
+		ConvertObjToMeshFile(objPath, path);
+
+		if(!OpenMeshFile(fileSystem, path, mesh)) throw std::runtime_error("Failed to load mesh file: " + path);
+	}
+
+	void AssetLoader::BakeFont(const std::string& path, float pixelHeight, FontBitmap& font) const {
+		PROFILE_SCOPE("Bake font");
+		AssetFile fontFile;
+		OpenFile(path, fontFile);
+		const unsigned char* fontData = fontFile.Data();
+
+		// Checked in the pack first like any other asset; freshly baked
+		// caches are written next to the loose font.
+		const uint64_t fontHash = Utils::HashBytes(fontData, fontFile.Size());
+		const std::string cachePath = AssetFileSystem::NormalizePath(path) + "." + std::to_string(static_cast<int>(pixelHeight)) + ".sdf";
+		if(LoadFontCache(cachePath, fontHash, pixelHeight, font)) return;
+
+		stbtt_fontinfo fontInfo;
+		if(!stbtt_InitFont(&fontInfo, fontData, stbtt_GetFontOffsetForIndex(fontData, 0))) {
+			throw std::runtime_error("Failed to init font info!");
+		}
+
+		int ascent, descent, lineGap;
+		stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
+
+		const float scale = stbtt_ScaleForPixelHeight(&fontInfo, pixelHeight);
+
+		// The edge sits at 128 and one pixel of distance is worth
+		// 128 / FONT_SDF_PADDING, so the padding spans the full 0..255 range.
+		const unsigned char onEdgeValue = 128;
+		const float pixelDistScale = static_cast<float>(onEdgeValue) / FONT_SDF_PADDING;
+
+		struct Glyph {
+			unsigned char* sdf;
+			int width, height, xoff, yoff;
+		};
+		Glyph glyphs[96];
+
+		//
+		// Render every glyph and shelf pack them into a fixed width atlas
+		//
+		static constexpr int ATLAS_WIDTH = 256;
+		static constexpr int GLYPH_GAP = 1;
+
+		int penX = 0, penY = 0, shelfHeight = 0;
+		for(int i = 0; i < 96; ++i) {
+			Glyph& glyph = glyphs[i];
+			glyph.sdf = stbtt_GetCodepointSDF(&fontInfo, scale, 32 + i, FONT_SDF_PADDING, onEdgeValue, pixelDistScale,
+				&glyph.width, &glyph.height, &glyph.xoff, &glyph.yoff);
+			if(!glyph.sdf) glyph.width = glyph.height = glyph.xoff = glyph.yoff = 0; // Blank glyph (space)
+
+			if(penX + glyph.width > ATLAS_WIDTH) {
+				penX = 0;
+				penY += shelfHeight + GLYPH_GAP;
+				shelfHeight = 0;
+			}
+
+			int advance, leftSideBearing;
+			stbtt_GetCodepointHMetrics(&fontInfo, 32 + i, &advance, &leftSideBearing);
+
+			stbtt_bakedchar& baked = font.bakedChars[i];
+			baked.x0 = static_cast<unsigned short>(penX);
+			baked.y0 = static_cast<unsigned short>(penY);
+			baked.x1 = static_cast<unsigned short>(penX + glyph.width);
+			baked.y1 = static_cast<unsigned short>(penY + glyph.height);
+			baked.xoff = static_cast<float>(glyph.xoff);
+			baked.yoff = static_cast<float>(glyph.yoff);
+			baked.xadvance = scale * advance;
+
+			penX += glyph.width + GLYPH_GAP;
+			shelfHeight = std::max(shelfHeight, glyph.height);
+		}
+
+		// Power of two height, just tall enough for the packed shelves.
+		int atlasHeight = 1;
+		while(atlasHeight < penY + shelfHeight) atlasHeight <<= 1;
+
+		font.width  = ATLAS_WIDTH;
+		font.height = atlasHeight;
+		font.ascent = ascent;
+		font.pixelHeight = pixelHeight;
+		font.bakedPixels.assign(static_cast<size_t>(font.width) * font.height, 0);
+		font.pixels = font.bakedPixels.data();
+
+		for(int i = 0; i < 96; ++i) {
+			const Glyph& glyph = glyphs[i];
+			if(!glyph.sdf) continue;
+
+			const stbtt_bakedchar& baked = font.bakedChars[i];
+			for(int row = 0; row < glyph.height; ++row) {
+				memcpy(&font.bakedPixels[(baked.y0 + row) * font.width + baked.x0], glyph.sdf + row * glyph.width, glyph.width);
+			}
+			stbtt_FreeSDF(glyph.sdf, nullptr);
+		}
+
+		SaveFontCache(cachePath, fontHash, font);
+	}
+
+	//
+	// Font atlas cache
+	//
+
+	struct FontCacheHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t fontHash;
+		float pixelHeight;
+		int32_t padding;
+		int32_t width;
+		int32_t height;
+		int32_t ascent;
+		uint32_t glyphCount;
+	};
+
+	static const char FONT_CACHE_MAGIC[4] = { 'P', 'S', 'D', 'F' };
+
+	bool AssetLoader::LoadFontCache(const std::string& cachePath, uint64_t fontHash, float pixelHeight, FontBitmap& font) const {
+		if(!fileSystem.Open(cachePath, font.cache)) return false;
+
+		const unsigned char* data = font.cache.Data();
+		const size_t size = font.cache.Size();
+
+		FontCacheHeader header;
+		if(size < sizeof(header)) {
+			font.cache.Close();
+			return false;
+		}
+		memcpy(&header, data, sizeof(header));
+
+		const size_t glyphBytes = sizeof(font.bakedChars);
+		const bool valid =
+			memcmp(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+			header.version == FONT_CACHE_VERSION &&
+			header.fontHash == fontHash &&
+			header.pixelHeight == pixelHeight &&
+			header.padding == FONT_SDF_PADDING &&
+			header.glyphCount == 96 &&
+			header.width > 0 && header.height > 0 &&
+			size == sizeof(header) + glyphBytes + static_cast<size_t>(header.width) * header.height;
+
+		if(!valid) {
+			DebugLog("Font cache is stale, rebaking: " + cachePath);
+			font.cache.Close();
+			return false;
+		}
+
+		font.width = header.width;
+		font.height = header.height;
+		font.ascent = header.ascent;
+		font.pixelHeight = header.pixelHeight;
+		memcpy(font.bakedChars, data + sizeof(header), glyphBytes);
+
+		// The atlas is uploaded straight out of the mapping.
+		font.pixels = data + sizeof(header) + glyphBytes;
+		return true;
+	}
+
+	void AssetLoader::SaveFontCache(const std::string& cachePath, uint64_t fontHash, const FontBitmap& font) {
+		FontCacheHeader header{};
+		memcpy(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic));
+		header.version = FONT_CACHE_VERSION;
+		header.fontHash = fontHash;
+		header.pixelHeight = font.pixelHeight;
+		header.padding = FONT_SDF_PADDING;
+		header.width = font.width;
+		header.height = font.height;
+		header.ascent = font.ascent;
+		header.glyphCount = 96;
+
+		const bool written = Utils::WriteFileAtomically(cachePath, [&](std::ofstream& file) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(font.bakedChars), sizeof(font.bakedChars));
+			file.write(reinterpret_cast<const char*>(font.pixels), static_cast<std::streamsize>(font.width) * font.height);
+		});
+
+		// Not fatal, the next launch just bakes again.
+		if(!written) DebugLog("Failed to write font cache: " + cachePath);
+	}
+}
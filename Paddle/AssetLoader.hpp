@@ -0,0 +1,104 @@
+#pragma once
+
+#include "JobSystem.hpp"
+#include "GameVertex.hpp"
+#include "AssetPack.hpp"
+#include "MeshFile.hpp"
+#include "Vendor\stb_truetype.h"
+
+#include <exception>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paddle {
+	// Signed distance field of printable ASCII (32..127) packed into one
+	// single channel atlas. 0.5 is the glyph edge, values fall off by
+	// 0.5 / FONT_SDF_PADDING per pixel. Glyph metrics are in pixels at
+	// pixelHeight; the rects include the padding.
+	struct FontBitmap {
+		int width = 0;
+		int height = 0;
+		int ascent = 0;
+		float pixelHeight = 0.0f;
+		stbtt_bakedchar bakedChars[96];
+		const unsigned char* pixels = nullptr; // width * height, points into one of the below
+
+		std::vector<unsigned char> bakedPixels;
+		AssetFile cache;
+	};
+
+	static constexpr int FONT_SDF_PADDING = 4;
+
+	// Baked atlases are cached next to the font as "<font>.<pixelHeight>.sdf"
+	// and keyed by a hash of the font file, so editing the TTF invalidates
+	// them. Bump the version whenever BakeFont() output changes.
+	static constexpr uint32_t FONT_CACHE_VERSION = 1;
+
+	// Reads (through the asset file system) and decodes assets on the job
+	// system so disk and CPU work overlaps with Vulkan initialization.
+	// Prefetch*() queues a load and returns right away, Get*() blocks until
+	// the asset is ready (running queued jobs in the meantime) and loads it
+	// inline if nobody prefetched it. Everything stays cached for the
+	// loader's lifetime, so repeated Get*() calls are free.
+	class AssetLoader {
+	public:
+		AssetLoader(JobSystem& jobs, const AssetFileSystem& fileSystem);
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+
+		// === Prefetch ===
+		void PrefetchFile(const std::string& path);
+		void PrefetchMesh(const std::string& path);
+		void PrefetchFont(const std::string& path, float pixelHeight);
+
+		// Any other startup work that should overlap with the loads. Wait()
+		// joins it and rethrows the first exception it threw.
+		void Run(JobFunction function);
+		void Wait();
+
+		// === Access ===
+		const AssetFile& GetFile(const std::string& path);
+		const MeshData& GetMesh(const std::string& path);
+		const FontBitmap& GetFont(const std::string& path, float pixelHeight);
+
+	private:
+		template <typename T>
+		struct Entry {
+			JobCounter ready;
+			std::exception_ptr error;
+			T data;
+		};
+
+		template <typename T>
+		using EntryTable = std::unordered_map<std::string, Entry<T>*>;
+
+		template <typename T, typename LoadFunction>
+		Entry<T>* Prefetch(EntryTable<T>& table, const std::string& path, LoadFunction load);
+		template <typename T>
+		const T& Get(Entry<T>* entry);
+		template <typename T>
+		void Destroy(EntryTable<T>& table);
+
+		void OpenFile(const std::string& path, AssetFile& file) const;
+		void LoadMesh(const std::string& path, MeshData& mesh) const;
+		void BakeFont(const std::string& path, float pixelHeight, FontBitmap& font) const;
+		bool LoadFontCache(const std::string& cachePath, uint64_t fontHash, float pixelHeight, FontBitmap& font) const;
+		static void SaveFontCache(const std::string& cachePath, uint64_t fontHash, const FontBitmap& font);
+
+		JobSystem& jobs;
+		const AssetFileSystem& fileSystem;
+
+		std::mutex tableMutex;
+		EntryTable<AssetFile> files;
+		EntryTable<MeshData> meshes;
+		EntryTable<FontBitmap> fonts; // Keyed by path and pixel height
+
+		JobCounter tasks;
+		std::mutex taskErrorMutex;
+		std::exception_ptr taskError;
+	};
+}
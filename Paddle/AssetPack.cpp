@@ -0,0 +1,402 @@
+#include "AssetPack.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	enum PackCompression {
+		PACK_COMPRESSION_NONE = 0,
+		PACK_COMPRESSION_LZ
+	};
+
+	struct PackHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t tocOffset;
+		uint64_t namesOffset;
+		uint64_t namesSize;
+	};
+
+	struct PackEntry {
+		uint64_t offset;
+		uint64_t storedSize;
+		uint64_t size;
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t compression;
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(PackHeader) == 40, "PackHeader layout is part of the file format");
+	static_assert(sizeof(PackEntry) == 40, "PackEntry layout is part of the file format");
+
+	static const char ASSET_PACK_MAGIC[4] = { 'P', 'P', 'A', 'K' };
+
+	// Only worth inflating at load time if it saves at least this much.
+	static constexpr float PACK_COMPRESSION_THRESHOLD = 0.9f;
+
+	//
+	// LZ codec
+	//
+	// Byte oriented LZ77 in the spirit of LZ4: a run of sequences, each a
+	// token (literal count << 4 | match length - 4, 15 meaning more length
+	// bytes follow, 255 per byte), the literals, then a 16-bit match offset.
+	// The last sequence is literals only. Decoding is a tight copy loop, a
+	// few hundred MB/s even in debug builds.
+	//
+
+	static constexpr uint32_t LZ_MIN_MATCH = 4;
+	static constexpr uint32_t LZ_MAX_OFFSET = 65535;
+	static constexpr uint32_t LZ_HASH_BITS = 14;
+
+	static uint32_t Read32(const unsigned char* p) {
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	static void WriteLength(std::vector<unsigned char>& out, size_t length) {
+		while(length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back(static_cast<unsigned char>(length));
+	}
+
+	static void WriteSequence(std::vector<unsigned char>& out, const unsigned char* literals, size_t literalCount, size_t offset, size_t matchLength) {
+		const size_t matchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+		out.push_back(static_cast<unsigned char>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+		if(literalCount >= 15) WriteLength(out, literalCount - 15);
+		out.insert(out.end(), literals, literals + literalCount);
+
+		if(!matchLength) return;
+		out.push_back(static_cast<unsigned char>(offset & 0xff));
+		out.push_back(static_cast<unsigned char>(offset >> 8));
+		if(matchCode >= 15) WriteLength(out, matchCode - 15);
+	}
+
+	static std::vector<unsigned char> CompressLz(const unsigned char* src, size_t size) {
+		std::vector<unsigned char> out;
+		out.reserve(size / 2);
+
+		std::vector<uint32_t> table(static_cast<size_t>(1) << LZ_HASH_BITS, UINT32_MAX);
+		size_t position = 0, anchor = 0;
+
+		while(position + LZ_MIN_MATCH <= size) {
+			const uint32_t sequence = Read32(src + position);
+			const uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+			const uint32_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(position);
+
+			if(candidate == UINT32_MAX || position - candidate > LZ_MAX_OFFSET || Read32(src + candidate) != sequence) {
+				++position;
+				continue;
+			}
+
+			size_t matchLength = LZ_MIN_MATCH;
+			while(position + matchLength < size && src[candidate + matchLength] == src[position + matchLength]) ++matchLength;
+
+			WriteSequence(out, src + anchor, position - anchor, position - candidate, matchLength);
+			position += matchLength;
+			anchor = position;
+		}
+
+		WriteSequence(out, src + anchor, size - anchor, 0, 0);
+		return out;
+	}
+
+	static bool ReadLength(const unsigned char*& in, const unsigned char* end, size_t& length) {
+		unsigned char byte;
+		do {
+			if(in >= end) return false;
+			byte = *in++;
+			length += byte;
+		} while(byte == 255);
+		return true;
+	}
+
+	// Returns false on malformed input instead of reading or writing out of bounds.
+	static bool DecompressLz(const unsigned char* in, size_t inSize, unsigned char* out, size_t outSize) {
+		const unsigned char* inEnd = in + inSize;
+		size_t written = 0;
+
+		while(in < inEnd) {
+			const unsigned char token = *in++;
+
+			size_t literalCount = token >> 4;
+			if(literalCount == 15 && !ReadLength(in, inEnd, literalCount)) return false;
+			if(literalCount > static_cast<size_t>(inEnd - in) || literalCount > outSize - written) return false;
+			memcpy(out + written, in, literalCount);
+			in += literalCount;
+			written += literalCount;
+
+			if(written == outSize) return in == inEnd; // Literals only, the last sequence
+
+			if(inEnd - in < 2) return false;
+			const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+			in += 2;
+
+			size_t matchLength = token & 0xf;
+			if(matchLength == 15 && !ReadLength(in, inEnd, matchLength)) return false;
+			matchLength += LZ_MIN_MATCH;
+
+			if(offset == 0 || offset > written || matchLength > outSize - written) return false;
+
+			// Byte by byte, matches may overlap what they are producing.
+			const unsigned char* match = out + written - offset;
+			for(size_t i = 0; i < matchLength; ++i) out[written + i] = match[i];
+			written += matchLength;
+		}
+
+		return written == outSize;
+	}
+
+	//
+	// AssetFile
+	//
+
+	void AssetFile::Close() {
+		data = nullptr;
+		size = 0;
+		looseFile.Close();
+		inflated.clear();
+		inflated.shrink_to_fit();
+	}
+
+	//
+	// AssetFileSystem
+	//
+
+	std::string AssetFileSystem::NormalizePath(const std::string& path) {
+		std::string normalized = path;
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		while(normalized.compare(0, 2, "./") == 0) normalized.erase(0, 2);
+		return normalized;
+	}
+
+	bool AssetFileSystem::MountPack(const std::string& packPath) {
+		if(!pack.Open(packPath)) return false;
+
+		const unsigned char* data = pack.Data();
+		const uint64_t size = pack.Size();
+
+		PackHeader header;
+		bool valid = size >= sizeof(header);
+		if(valid) {
+			memcpy(&header, data, sizeof(header));
+			valid =
+				memcmp(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic)) == 0 &&
+				header.version == ASSET_PACK_VERSION &&
+				header.tocOffset + static_cast<uint64_t>(header.entryCount) * sizeof(PackEntry) <= size &&
+				header.namesOffset + header.namesSize <= size;
+		}
+
+		for(uint32_t i = 0; valid && i < header.entryCount; ++i) {
+			PackEntry entry;
+			memcpy(&entry, data + header.tocOffset + i * sizeof(PackEntry), sizeof(entry));
+
+			valid =
+				static_cast<uint64_t>(entry.nameOffset) + entry.nameLength <= header.namesSize &&
+				entry.offset % ASSET_PACK_ALIGNMENT == 0 &&
+				entry.offset + entry.storedSize <= size &&
+				(entry.compression == PACK_COMPRESSION_LZ || (entry.compression == PACK_COMPRESSION_NONE && entry.storedSize == entry.size));
+			if(!valid) break;
+
+			const std::string name(reinterpret_cast<const char*>(data + header.namesOffset + entry.nameOffset), entry.nameLength);
+			entries[name] = PackedEntry{ entry.offset, entry.storedSize, entry.size, entry.compression };
+		}
+
+		if(!valid) {
+			DebugLog("Asset pack is stale or corrupt, using loose files: " + packPath);
+			entries.clear();
+			pack.Close();
+			return false;
+		}
+
+		DebugLog("Mounted asset pack " + packPath + " with " + std::to_string(entries.size()) + " entries.");
+		return true;
+	}
+
+	void AssetFileSystem::AddEmbedded(const std::string& path, const void* data, size_t size) {
+		embedded[NormalizePath(path)] = EmbeddedEntry{ static_cast<const unsigned char*>(data), size };
+	}
+
+	bool AssetFileSystem::OpenLoose(const std::string& virtualPath, AssetFile& file) const {
+		// Forward slashes work with the Win32 file API as well.
+		if(!file.looseFile.Open(virtualPath)) return false;
+		file.data = file.looseFile.Data();
+		file.size = file.looseFile.Size();
+		return true;
+	}
+
+	bool AssetFileSystem::Open(const std::string& path, AssetFile& file) const {
+		file.Close();
+		const std::string virtualPath = NormalizePath(path);
+
+		if(preferLooseFiles && OpenLoose(virtualPath, file)) {
+			DebugLog("Loose override: " + virtualPath);
+			return true;
+		}
+
+		auto it = entries.find(virtualPath);
+		if(it == entries.end()) {
+			auto builtIn = embedded.find(virtualPath);
+			if(builtIn != embedded.end()) {
+				file.data = builtIn->second.data;
+				file.size = builtIn->second.size;
+				return true;
+			}
+
+			return !preferLooseFiles && OpenLoose(virtualPath, file);
+		}
+
+		const PackedEntry& entry = it->second;
+		const unsigned char* stored = pack.Data() + entry.offset;
+
+		if(entry.compression == PACK_COMPRESSION_NONE) {
+			file.data = stored;
+			file.size = static_cast<size_t>(entry.size);
+			return true;
+		}
+
+		file.inflated.resize(static_cast<size_t>(entry.size));
+		if(!DecompressLz(stored, static_cast<size_t>(entry.storedSize), file.inflated.data(), file.inflated.size())) {
+			DebugLog("Corrupt asset pack entry: " + virtualPath);
+			file.Close();
+			return false;
+		}
+		file.data = file.inflated.data();
+		file.size = file.inflated.size();
+		return true;
+	}
+
+	//
+	// Pack builder
+	//
+
+	static std::vector<std::string> ReadManifest(const std::string& manifestPath) {
+		std::ifstream manifest{ manifestPath };
+		if(!manifest.is_open()) throw std::runtime_error("Failed to open file: " + manifestPath);
+
+		std::vector<std::string> paths;
+		std::string line;
+		while(std::getline(manifest, line)) {
+			line = line.substr(0, line.find('#'));
+			const size_t first = line.find_first_not_of(" \t\r");
+			if(first == std::string::npos) continue;
+			const size_t last = line.find_last_not_of(" \t\r");
+			paths.push_back(AssetFileSystem::NormalizePath(line.substr(first, last - first + 1)));
+		}
+		return paths;
+	}
+
+	static bool EndsWith(const std::string& value, const std::string& suffix) {
+		return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	static void WritePadding(std::ofstream& file) {
+		static const char zeros[ASSET_PACK_ALIGNMENT] = {};
+		const uint64_t written = static_cast<uint64_t>(file.tellp());
+		const uint64_t padding = (ASSET_PACK_ALIGNMENT - written % ASSET_PACK_ALIGNMENT) % ASSET_PACK_ALIGNMENT;
+		file.write(zeros, static_cast<std::streamsize>(padding));
+	}
+
+	static void BuildPack(const std::vector<std::string>& paths, const std::string& packPath) {
+		std::vector<PackEntry> toc;
+		std::string names;
+		uint64_t totalSize = 0, totalStored = 0;
+
+		const bool written = Utils::WriteFileAtomically(packPath, [&](std::ofstream& file) {
+			PackHeader header{};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			for(const auto& path : paths) {
+				MappedFile source;
+				if(!source.Open(path)) throw std::runtime_error("Failed to open file: " + path);
+
+				PackEntry entry{};
+				entry.nameOffset = static_cast<uint32_t>(names.size());
+				entry.nameLength = static_cast<uint32_t>(path.size());
+				entry.size = source.Size();
+				names += path;
+
+				// Meshes are read in place straight out of the mapping, never
+				// compress them. Everything else only if it pays for the inflate.
+				std::vector<unsigned char> compressed;
+				if(!EndsWith(path, ".pmesh")) compressed = CompressLz(source.Data(), source.Size());
+				const bool useCompressed = !compressed.empty() && compressed.size() < source.Size() * PACK_COMPRESSION_THRESHOLD;
+
+				WritePadding(file);
+				entry.offset = static_cast<uint64_t>(file.tellp());
+				if(useCompressed) {
+					entry.compression = PACK_COMPRESSION_LZ;
+					entry.storedSize = compressed.size();
+					file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+				}
+				else {
+					entry.compression = PACK_COMPRESSION_NONE;
+					entry.storedSize = source.Size();
+					file.write(reinterpret_cast<const char*>(source.Data()), static_cast<std::streamsize>(source.Size()));
+				}
+				toc.push_back(entry);
+
+				totalSize += entry.size;
+				totalStored += entry.storedSize;
+				printf("  %-40s %9llu -> %9llu %s\n", path.c_str(), static_cast<unsigned long long>(entry.size),
+					static_cast<unsigned long long>(entry.storedSize), useCompressed ? "lz" : "stored");
+			}
+
+			WritePadding(file);
+			memcpy(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic));
+			header.version = ASSET_PACK_VERSION;
+			header.entryCount = static_cast<uint32_t>(toc.size());
+			header.tocOffset = static_cast<uint64_t>(file.tellp());
+			header.namesOffset = header.tocOffset + toc.size() * sizeof(PackEntry);
+			header.namesSize = names.size();
+
+			file.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackEntry)));
+			file.write(names.data(), static_cast<std::streamsize>(names.size()));
+			file.seekp(0);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		});
+
+		if(!written) throw std::runtime_error("Failed to write asset pack: " + packPath);
+
+		printf("%s: %zu entries, %llu -> %llu bytes\n", packPath.c_str(), toc.size(),
+			static_cast<unsigned long long>(totalSize), static_cast<unsigned long long>(totalStored));
+	}
+
+	int RunPackBuilder(const std::string& manifestPath, const std::string& packPath) {
+		try {
+			BuildPack(ReadManifest(manifestPath), packPath);
+
+			// Read every entry back through the same path the game uses.
+			AssetFileSystem files;
+			if(!files.MountPack(packPath)) throw std::runtime_error("Failed to mount the written pack: " + packPath);
+			for(const auto& path : ReadManifest(manifestPath)) {
+				AssetFile packed;
+				MappedFile source;
+				if(!files.Open(path, packed) || !source.Open(path) || packed.Size() != source.Size() ||
+					memcmp(packed.Data(), source.Data(), source.Size()) != 0) {
+					throw std::runtime_error("Pack entry does not match its source: " + path);
+				}
+			}
+		}
+		catch (const std::exception& e) {
+			fprintf(stderr, "Asset pack build failed: %s\n", e.what());
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Paddle {
+	// Mounted at startup if present, relative to the working directory.
+	static constexpr const char* ASSET_PACK_PATH = "Paddle.pak";
+
+	// .pak layout, all little endian:
+	//   PackHeader
+	//   entry data, each entry ASSET_PACK_ALIGNMENT aligned
+	//   PackEntry[entryCount]
+	//   entry names, not null terminated
+	// Entries are either stored as is (and read straight out of the mapping)
+	// or LZ compressed and inflated into memory when opened. Bump the version
+	// whenever the layout or the compression format changes.
+	static constexpr uint32_t ASSET_PACK_VERSION = 1;
+	static constexpr uint32_t ASSET_PACK_ALIGNMENT = 16;
+
+	// One opened asset. The bytes point into the mounted pack, the
+	// executable, a mapping of the loose file or a buffer the entry was
+	// inflated into; they stay valid for as long as the AssetFile (and the
+	// file system) lives.
+	class AssetFile {
+	public:
+		AssetFile() = default;
+
+		AssetFile(const AssetFile&) = delete;
+		AssetFile& operator=(const AssetFile&) = delete;
+
+		void Close();
+
+		bool IsOpen() const { return data != nullptr; }
+		bool IsLoose() const { return looseFile.IsOpen(); }
+		const unsigned char* Data() const { return data; }
+		size_t Size() const { return size; }
+
+	private:
+		friend class AssetFileSystem;
+
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+
+		MappedFile looseFile;
+		std::vector<unsigned char> inflated;
+	};
+
+	// Every asset is opened through here by its virtual path: forward
+	// slashes, relative to the project directory ("Shader/Brick.pmesh").
+	// Backslashes are accepted and normalized, so lookups behave the same on
+	// every platform. The mounted pack is searched first, then data linked
+	// into the binary; anything neither has is opened from disk, so
+	// development builds work without a pack. Read only once set up, safe
+	// to open from any thread.
+	class AssetFileSystem {
+	public:
+		AssetFileSystem() = default;
+
+		AssetFileSystem(const AssetFileSystem&) = delete;
+		AssetFileSystem& operator=(const AssetFileSystem&) = delete;
+
+		// Maps the pack. Returns false (and keeps using loose files) if it is
+		// missing, corrupt or from an older version. Mount before any Open().
+		bool MountPack(const std::string& packPath);
+		bool IsPackMounted() const { return pack.IsOpen(); }
+
+		// Serves data that lives in the executable (e.g. embedded SPIR-V)
+		// under a virtual path, without copying it. Add before any Open().
+		void AddEmbedded(const std::string& path, const void* data, size_t size);
+
+		// Development overrides: loose files on disk win over the pack and
+		// embedded data, so a recompiled shader or re-exported mesh can be
+		// tried without rebuilding either.
+		void SetPreferLooseFiles(bool prefer) { preferLooseFiles = prefer; }
+
+		// Returns false if neither the pack nor the disk has the file.
+		bool Open(const std::string& path, AssetFile& file) const;
+
+		static std::string NormalizePath(const std::string& path);
+
+	private:
+		struct PackedEntry {
+			uint64_t offset;
+			uint64_t storedSize;
+			uint64_t size;
+			uint32_t compression;
+		};
+
+		struct EmbeddedEntry {
+			const unsigned char* data;
+			size_t size;
+		};
+
+		bool OpenLoose(const std::string& virtualPath, AssetFile& file) const;
+
+		MappedFile pack;
+		std::unordered_map<std::string, PackedEntry> entries;
+		std::unordered_map<std::string, EmbeddedEntry> embedded;
+		bool preferLooseFiles = false;
+	};
+
+	// Offline entry point for --build-pack. Packs every virtual path listed
+	// in the manifest (one per line, '#' starts a comment) from the loose
+	// files. Returns a process exit code.
+	int RunPackBuilder(const std::string& manifestPath, const std::string& packPath);
+}
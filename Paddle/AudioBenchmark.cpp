@@ -0,0 +1,113 @@
+#include "AudioBenchmark.hpp"
+#include "GameSounds.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <vector>
+
+namespace Paddle {
+	// Same chunk the low latency device asks for, so per-chunk peaks are
+	// comparable with a real callback budget.
+	static constexpr uint32_t BENCH_CHUNK_FRAMES = 256;
+	static constexpr float    BENCH_DURATION_SECONDS = 20.0f;
+	static constexpr int      BENCH_PASSES = 3;
+
+	struct SfxEvent {
+		float time; // Seconds from the start of the timeline
+		GameSoundsSfx sfx;
+		bool stop;
+	};
+
+	// A rally with regular paddle/wall bounces, broken up by a rainbow block
+	// that detonates the whole board (TNT chains, bonus, reset) twice.
+	static std::vector<SfxEvent> BuildTimeline() {
+		std::vector<SfxEvent> events;
+
+		for (float t = 0.5f; t < BENCH_DURATION_SECONDS; t += 0.9f) {
+			events.push_back({ t, SFX_PADDLE_BOUNCE, false });
+			events.push_back({ t + 0.45f, SFX_WALL_BOUNCE, false });
+		}
+
+		const float storms[] = { 4.0f, 13.0f };
+		for (float start : storms) {
+			// One sim tick per explosion wave, every block on the board.
+			for (int tick = 0; tick < 24; ++tick) {
+				const float t = start + tick / 60.0f;
+				for (int block = 0; block < 3; ++block) events.push_back({ t, SFX_BLOCK_EXPLOSION, false });
+				if (tick % 4 == 0) events.push_back({ t, SFX_BONUS, false });
+			}
+			events.push_back({ start + 0.6f, SFX_LOOT_PICKUP, false });
+			events.push_back({ start + 1.0f, SFX_BLOCKS_RESET, false });
+		}
+
+		events.push_back({ 8.0f, SFX_BULLET, false });
+		events.push_back({ 11.0f, SFX_BULLET, true });
+		events.push_back({ 18.0f, SFX_GAME_OVER, false });
+
+		std::stable_sort(events.begin(), events.end(), [](const SfxEvent& a, const SfxEvent& b) {
+			return a.time < b.time;
+		});
+		return events;
+	}
+
+	static void RunPass(const std::vector<SfxEvent>& timeline, int pass) {
+		AssetFileSystem files;
+		files.MountPack(ASSET_PACK_PATH);
+
+		AudioConfig config;
+		config.offline = true;
+		GameSounds sounds(config, files);
+
+		const uint32_t channels = sounds.GetChannelCount();
+		const uint32_t sampleRate = sounds.GetSampleRate();
+		const uint64_t totalFrames = static_cast<uint64_t>(BENCH_DURATION_SECONDS * sampleRate);
+		std::vector<float> chunk(BENCH_CHUNK_FRAMES * channels);
+
+		sounds.PlayBgm();
+
+		size_t nextEvent = 0;
+		double totalSeconds = 0.0;
+		double worstChunkSeconds = 0.0;
+
+		for (uint64_t frame = 0; frame < totalFrames; frame += BENCH_CHUNK_FRAMES) {
+			const float now = static_cast<float>(frame) / sampleRate;
+			for (; nextEvent < timeline.size() && timeline[nextEvent].time <= now; ++nextEvent) {
+				if (timeline[nextEvent].stop) sounds.StopSfx(timeline[nextEvent].sfx);
+				else sounds.PlaySfx(timeline[nextEvent].sfx);
+			}
+
+			const auto begin = std::chrono::steady_clock::now();
+			sounds.RenderOffline(chunk.data(), BENCH_CHUNK_FRAMES);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+			totalSeconds += seconds;
+			worstChunkSeconds = std::max(worstChunkSeconds, seconds);
+		}
+
+		const double audioSeconds = static_cast<double>(totalFrames) / sampleRate;
+		const double chunkBudgetMs = 1000.0 * BENCH_CHUNK_FRAMES / sampleRate;
+		printf("pass %d: %.1fs of audio in %.2fms | %.3f ms CPU per audio second | worst chunk %.3fms of %.3fms budget\n",
+			pass, audioSeconds, totalSeconds * 1000.0, totalSeconds * 1000.0 / audioSeconds,
+			worstChunkSeconds * 1000.0, chunkBudgetMs);
+	}
+
+	int RunAudioBenchmark() {
+		try {
+			const std::vector<SfxEvent> timeline = BuildTimeline();
+			printf("Audio benchmark: %zu events over %.0fs, %u frame chunks\n",
+				timeline.size(), BENCH_DURATION_SECONDS, BENCH_CHUNK_FRAMES);
+
+			for (int pass = 1; pass <= BENCH_PASSES; ++pass)
+				RunPass(timeline, pass);
+		}
+		catch (const std::exception& e) {
+			fprintf(stderr, "Audio benchmark failed: %s\n", e.what());
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace Paddle {
+	// Replays a fixed SFX timeline through an offline GameSounds (no audio
+	// device needed) and prints how much CPU the mixer burns per second of
+	// audio. Returns a process exit code.
+	int RunAudioBenchmark();
+}
@@ -1,6 +1,7 @@
 #include "Ball.hpp"
 #include "VkDevice.hpp"
 #include "Bullet.hpp"
+#include "MeshOptimizer.hpp"
 
 #include <glm/gtc/constants.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
@@ -16,8 +17,11 @@ namespace Paddle {
 	const uint32_t BALL_STACKS = 32;
 
 	Ball::Ball(GameContext& context) : GameEntity(context) {
+		tintColor = glm::vec4(194.0f / 255.f, 64.0f / 255.0f, 62.0f / 255.0f, 1.0f); // #c2403e
 		verticesInstance = GenerateVertices();
 		indicesInstance = GenerateIndices();
+		OptimizeMesh("Ball", verticesInstance, indicesInstance);
+		lods = BuildLodChain(verticesInstance, indicesInstance);
 		Reset();
 		InitialiseEntity();
 	}
@@ -113,11 +117,10 @@ namespace Paddle {
 				float z = radius * sin(phi) * sin(theta);
 
 				glm::vec3 pos = glm::vec3(x, y, z);
-				glm::vec3 color = glm::vec3(194.0f / 255.f, 64.0f / 255.0f, 62.0f / 255.0f); // #c2403e
 				glm::vec3 normal = glm::normalize(pos);
 				glm::vec2 uv = glm::vec2((float)j / BALL_SLICES, (float)i / BALL_STACKS);
 
-				vertices.push_back({ pos, color, normal, uv });
+				vertices.push_back({ pos, normal, uv });
 			}
 		}
 		return vertices;
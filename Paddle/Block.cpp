@@ -2,15 +2,17 @@
 #include "VkDevice.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/random.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/epsilon.hpp>
 
+#include <cmath>
 #include <cstring>
 
 #include "Utils.hpp"
 
 using Utils::RandomChance;
 using Utils::RandomNumber;
+using Utils::RandomFloat;
 using Utils::DebugLog;
 
 namespace Paddle {
@@ -22,6 +24,8 @@ namespace Paddle {
 	static constexpr float TNT_PROB = 0.2f;
 	static constexpr float RAINBOW_PROB = 0.05f;
 
+	static const char* BRICK_MODEL_PATH = "Shader/Brick.pmesh";
+
 	static const std::vector<glm::vec3> colors = {
 		{15.0f / 255.0f, 30.0f / 255.0f, 63.0f / 255.0f},    // Dark Blue - #0f1e3f
 		{213.0f / 255.0f, 21.0f / 255.0f, 24.0f / 255.0f},   // Bright Red - #d51518
@@ -30,6 +34,16 @@ namespace Paddle {
 		{242.0f / 255.0f, 242.0f / 255.0f, 242.0f / 255.0f}, // White - #f2f2f2
 	};
 
+	// Stands in for glm::sphericalRand, which goes through std::rand: its
+	// state is per thread on MSVC (every job thread starting from seed 1) and
+	// behind a lock elsewhere, and Update() runs on job threads.
+	static glm::vec3 RandomOnSphere(float radius) {
+		const float z = RandomFloat(-1.0f, 1.0f);
+		const float angle = RandomFloat(0.0f, glm::two_pi<float>());
+		const float r = std::sqrt(1.0f - z * z);
+		return glm::vec3(r * std::cos(angle), r * std::sin(angle), z) * radius;
+	}
+
 	Block::Block(GameContext& context, float x, float y, float z, const glm::vec3& color) : GameEntity(context) {
 		allBlocksRef = nullptr;
 		allLootsRef  = nullptr;
@@ -52,10 +66,18 @@ namespace Paddle {
 		SetRotation(glm::vec3(glm::radians(-90.0f), 0.0f, 0.0f));
 		SetPosition(glm::vec3(x, y, z));
 
-		LoadModel("Shader\\Brick.obj");
+		LoadModel(BRICK_MODEL_PATH);
 		InitialiseEntity();
 	}
 
+	void Block::Prefetch(AssetLoader& assets) {
+		assets.PrefetchMesh(BRICK_MODEL_PATH);
+	}
+
+	const MeshData& Block::GetMesh(AssetLoader& assets) {
+		return assets.GetMesh(BRICK_MODEL_PATH);
+	}
+
 	void Block::CreateBlocks(GameContext& context, std::vector<Block*>& blocks, std::vector<Loot*>& loots) {
 		const float startX = -BLOCK_SPACING * 2;
 		const float startY = -BLOCK_SPACING * 2;
@@ -135,13 +157,13 @@ namespace Paddle {
 					piece.position = glm::vec3(x, y, z) * 0.125f;
 
 					glm::vec3 baseDir = glm::normalize(piece.position);
-					glm::vec3 randomDir = glm::sphericalRand(0.5f);
+					glm::vec3 randomDir = RandomOnSphere(0.5f);
 					glm::vec3 velocityDir = glm::normalize(baseDir + randomDir);
-					float speed = glm::linearRand(0.8f, 2.5f);
+					float speed = RandomFloat(0.8f, 2.5f);
 
 					piece.velocity = velocityDir * speed;
-					piece.rotationAxis = glm::sphericalRand(1.0f);
-					piece.rotationSpeed = glm::linearRand(1.0f, 3.0f);
+					piece.rotationAxis = RandomOnSphere(1.0f);
+					piece.rotationSpeed = RandomFloat(1.0f, 3.0f);
 					piece.scale = 1.0f;
 					explodedPieces.push_back(piece);
 				}
@@ -155,7 +177,6 @@ namespace Paddle {
 				lastColoChangeTime = time(NULL);
 				const int random = RandomNumber(0, static_cast<int>(colors.size()) - 1);
 				tintColor = glm::vec4(colors[random], 1.0f);
-				UpdateVertexColors(tintColor);
 			}
 		}
 		if(!isExplosionInitiated || isExploded) return;
@@ -174,11 +195,11 @@ namespace Paddle {
 				piece.hasSubExploded = true;
 				for (int i = 0; i < 4; ++i) {
 					CubePiece subPiece;
-					subPiece.position = piece.position + glm::sphericalRand(0.03f);
-					glm::vec3 randomDir = glm::sphericalRand(1.0f);
-					subPiece.velocity = glm::normalize(randomDir) * glm::linearRand(0.5f, 1.5f);
-					subPiece.rotationAxis = glm::sphericalRand(1.0f);
-					subPiece.rotationSpeed = glm::linearRand(1.0f, 3.0f);
+					subPiece.position = piece.position + RandomOnSphere(0.03f);
+					glm::vec3 randomDir = RandomOnSphere(1.0f);
+					subPiece.velocity = glm::normalize(randomDir) * RandomFloat(0.5f, 1.5f);
+					subPiece.rotationAxis = RandomOnSphere(1.0f);
+					subPiece.rotationSpeed = RandomFloat(1.0f, 3.0f);
 					subPiece.scale = piece.scale * 0.5f;
 					subPiece.hasSubExploded = true;
 					newSubPieces.push_back(subPiece);
@@ -199,29 +220,17 @@ namespace Paddle {
 		return glm::vec3(0.25f);
 	}
 
-	void Block::Draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet) {
+	template <typename EmitFunction>
+	void Block::ForEachInstance(EmitFunction emit) const {
 		if (isExplosionInitiated) {
 			for (const auto& piece : explodedPieces) {
 				if (piece.scale <= 0.0f) continue;
 				glm::mat4 model = glm::translate(glm::mat4(1.0f), position + piece.position);
 				model = glm::rotate(model, piece.currentAngle, piece.rotationAxis);
 				model = glm::scale(model, glm::vec3(piece.scale * 0.5f));
+				model = model * meshTransform;
 
-				vkCmdPushConstants(
-					commandBuffer,
-					pipelineLayout,
-					VK_SHADER_STAGE_VERTEX_BIT,
-					0,
-					sizeof(glm::mat4),
-					&model
-				);
-
-				VkBuffer vertexBuffers[] = { vertexBuffer };
-				VkDeviceSize offsets[] = { 0 };
-				vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-				vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-				vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-				vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indicesInstance.size()), 1, 0, 0, 0);
+				emit(model, position + piece.position, boundingRadius * piece.scale * 0.5f);
 			}
 		}
 		else {
@@ -230,22 +239,24 @@ namespace Paddle {
 			model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0, 1, 0));
 			model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0, 0, 1));
 			model = glm::scale(model, glm::vec3(1.0f));
+			model = model * meshTransform;
 
-			vkCmdPushConstants(
-				commandBuffer,
-				pipelineLayout,
-				VK_SHADER_STAGE_VERTEX_BIT,
-				0,
-				sizeof(glm::mat4),
-				&model
-			);
-
-			VkBuffer vertexBuffers[] = { vertexBuffer };
-			VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-			vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indicesInstance.size()), 1, 0, 0, 0);
+			emit(model, position, boundingRadius);
 		}
 	}
+
+	void Block::CollectDrawCommands(const DrawView& view, std::vector<DrawCommand>& commands) {
+		ForEachInstance([&](const glm::mat4& model, const glm::vec3& center, float radius) {
+			if (!view.frustum.IntersectsSphere(center, radius)) return;
+
+			const MeshLod& lod = SelectLod(view, center, radius);
+			commands.push_back(DrawCommand{ model, tintColor, vertexBuffer, indexBuffer, lod.firstIndex, lod.indexCount });
+		});
+	}
+
+	void Block::CollectInstances(std::vector<GpuInstance>& instances) const {
+		ForEachInstance([&](const glm::mat4& model, const glm::vec3& center, float radius) {
+			instances.push_back(GpuInstance{ model, tintColor, glm::vec4(center, radius) });
+		});
+	}
 }
\ No newline at end of file
@@ -32,9 +32,13 @@ namespace Paddle {
 		void SetAllBlocksRef(std::vector<Block*>* ref) { allBlocksRef = ref; } 
 		void SetAllLootsRef(std::vector<Loot*>* ref) { allLootsRef = ref; }
 		static void CreateBlocks(GameContext& context, std::vector<Block*>& blocks, std::vector<Loot*>& loots);
+		static void Prefetch(AssetLoader& assets);
+		static const MeshData& GetMesh(AssetLoader& assets);
 
 		glm::vec3 GetHalfExtents() const override;
-		void Draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet) override;
+		void CollectDrawCommands(const DrawView& view, std::vector<DrawCommand>& commands) override;
+		// GPU-driven path: everything drawn, culling and LOD are left to the GPU.
+		void CollectInstances(std::vector<GpuInstance>& instances) const;
 		void Update() override;
 
 		void InitExplosion();
@@ -50,5 +54,10 @@ namespace Paddle {
 		bool isExploded;
 		bool isExplosionInitiated;
 		std::vector<CubePiece> explodedPieces;
+
+		// Calls emit(model, center, radius) for the whole block, or for
+		// every debris piece still visible once it exploded.
+		template <typename EmitFunction>
+		void ForEachInstance(EmitFunction emit) const;
 	};
 }
@@ -6,17 +6,18 @@
 namespace Paddle {
 	Bullet::Bullet(GameContext& context, float x, float y, float z)
 		: GameEntity(context)  {
+		tintColor = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 		verticesInstance = {
 			// Front face
-			{{-0.01f, -0.01f,  0.01f}, {0,0,1}, {0,0,1}, {0,0}},
-			{{ 0.01f, -0.01f,  0.01f}, {0,0,1}, {0,0,1}, {1,0}},
-			{{ 0.01f,  0.01f,  0.01f}, {0,0,1}, {0,0,1}, {1,1}},
-			{{-0.01f,  0.01f,  0.01f}, {0,0,1}, {0,0,1}, {0,1}},
+			{{-0.01f, -0.01f,  0.01f}, {0,0,1}, {0,0}},
+			{{ 0.01f, -0.01f,  0.01f}, {0,0,1}, {1,0}},
+			{{ 0.01f,  0.01f,  0.01f}, {0,0,1}, {1,1}},
+			{{-0.01f,  0.01f,  0.01f}, {0,0,1}, {0,1}},
 			// Back face
-			{{-0.01f, -0.01f, -0.01f}, {0,0,1}, {0,0,-1}, {1,0}},
-			{{ 0.01f, -0.01f, -0.01f}, {0,0,1}, {0,0,-1}, {0,0}},
-			{{ 0.01f,  0.01f, -0.01f}, {0,0,1}, {0,0,-1}, {0,1}},
-			{{-0.01f,  0.01f, -0.01f}, {0,0,1}, {0,0,-1}, {1,1}},
+			{{-0.01f, -0.01f, -0.01f}, {0,0,-1}, {1,0}},
+			{{ 0.01f, -0.01f, -0.01f}, {0,0,-1}, {0,0}},
+			{{ 0.01f,  0.01f, -0.01f}, {0,0,-1}, {0,1}},
+			{{-0.01f,  0.01f, -0.01f}, {0,0,-1}, {1,1}},
 		};
 		indicesInstance = {
 			0, 1, 2, 2, 3, 0,  // Front face
@@ -0,0 +1,42 @@
+#include "EmbeddedShaders.hpp"
+
+#include <cstdint>
+
+namespace Paddle {
+	// Each generated .spv.inc is glslc -mfmt=c output: one brace enclosed
+	// list of SPIR-V words, found through $(IntDir)Shaders.
+	static constexpr uint32_t SHADER_VERT_SPV[] =
+#include "shader.vert.spv.inc"
+	;
+	static constexpr uint32_t SHADER_FRAG_SPV[] =
+#include "shader.frag.spv.inc"
+	;
+	static constexpr uint32_t FONT_VERT_SPV[] =
+#include "font.vert.spv.inc"
+	;
+	static constexpr uint32_t FONT_FRAG_SPV[] =
+#include "font.frag.spv.inc"
+	;
+	static constexpr uint32_t CULL_COMP_SPV[] =
+#include "cull.comp.spv.inc"
+	;
+
+	struct EmbeddedShader {
+		const char* path;
+		const uint32_t* code;
+		size_t size;
+	};
+
+	static const EmbeddedShader EMBEDDED_SHADERS[] = {
+		{ "Shader/shader.vert.spv", SHADER_VERT_SPV, sizeof(SHADER_VERT_SPV) },
+		{ "Shader/shader.frag.spv", SHADER_FRAG_SPV, sizeof(SHADER_FRAG_SPV) },
+		{ "Shader/font.vert.spv",   FONT_VERT_SPV,   sizeof(FONT_VERT_SPV) },
+		{ "Shader/font.frag.spv",   FONT_FRAG_SPV,   sizeof(FONT_FRAG_SPV) },
+		{ "Shader/cull.comp.spv",   CULL_COMP_SPV,   sizeof(CULL_COMP_SPV) },
+	};
+
+	void RegisterEmbeddedShaders(AssetFileSystem& files) {
+		for(const auto& shader : EMBEDDED_SHADERS)
+			files.AddEmbedded(shader.path, shader.code, shader.size);
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "AssetPack.hpp"
+
+namespace Paddle {
+	// SPIR-V compiled from Shader/*.vert and *.frag by the glslc custom build
+	// step (see Paddle.vcxproj) and linked into the executable. Registered
+	// under the paths the .spv files used to be loaded from, so pipelines
+	// create their modules straight from the binary and the shaders can
+	// never be stale relative to the build. --loose-assets lets .spv files
+	// built with compile_shaders.bat override them during development.
+	void RegisterEmbeddedShaders(AssetFileSystem& files);
+}
@@ -2,8 +2,10 @@
 #include "GameSounds.hpp"
 #include "GameCamera.hpp"
 #include "GameFont.hpp"
+#include "EmbeddedShaders.hpp"
 #include "Utils.hpp"
 #include "FlashText.hpp"
+#include "Profiler.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
@@ -12,7 +14,13 @@
 #include <stdexcept>
 #include <array>
 #include <ctime>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 using Utils::DebugLog;
 using Utils::DestroyPtrs;
@@ -30,32 +38,117 @@ namespace Paddle {
 
 	static constexpr int BULLET_MAX_TIME = 5;
 
-	Game::Game() : window(WIDTH, HEIGHT, "Paddle POV") {
+	static constexpr uint32_t BLOCK_UPDATE_GRAIN = 4;
+
+	// Gameplay constants (speeds, timers in ticks) are tuned per tick, so the
+	// simulation runs at a fixed rate no matter how fast frames are presented.
+	static constexpr auto SIM_TICK_DURATION = std::chrono::microseconds(1000000 / 60);
+
+	static const char* VERT_SHADER_PATH = "Shader/shader.vert.spv";
+	static const char* FRAG_SHADER_PATH = "Shader/shader.frag.spv";
+
+	// constant_id values in shader.vert.
+	static constexpr uint32_t SHADER_CONSTANT_LIGHT_DIRECTION_X = 0;
+	static constexpr uint32_t SHADER_CONSTANT_LIGHT_DIRECTION_Y = 1;
+	static constexpr uint32_t SHADER_CONSTANT_LIGHT_DIRECTION_Z = 2;
+	static constexpr uint32_t SHADER_CONSTANT_AMBIENT           = 3;
+	static constexpr uint32_t SHADER_CONSTANT_LIGHTING          = 4;
+	static constexpr uint32_t SHADER_CONSTANT_GPU_DRIVEN        = 5;
+
+	// Zone names of the secondary recorded for each DrawCategory.
+	static const char* DRAW_CATEGORY_ZONE_NAMES[DRAW_CATEGORY_COUNT] = {
+		"Record blocks",
+		"Record ball",
+		"Record loots",
+		"Record bullets",
+		"Record text",
+	};
+
+	Game::Game(const GameOptions& options)
+		: window(WIDTH, HEIGHT, "Paddle POV"), shading(options.shading),
+		  tracePath(options.tracePath), traceWindowSeconds(options.traceWindowSeconds) {
+		PROFILE_THREAD("Main");
+		PROFILE_SCOPE("Startup");
+		const auto startupBegin = std::chrono::steady_clock::now();
+
+		//
+		// Start disk and CPU bound loading before Vulkan comes up
+		//
+		// Owned here until GameContext takes them. If Vulkan setup throws
+		// first, they unwind in reverse: the loader's destructor joins the
+		// jobs still in flight (including the one filling in sounds) before
+		// anything they write to goes away.
+		//
+		// One mapping for every asset; loose files if there is no pack.
+		std::unique_ptr<AssetFileSystem> files(new AssetFileSystem());
+		if(!files->MountPack(ASSET_PACK_PATH)) DebugLog("No asset pack, loading loose files.");
+		RegisterEmbeddedShaders(*files);
+		files->SetPreferLooseFiles(options.preferLooseAssets);
+
+		std::unique_ptr<JobSystem> jobs(new JobSystem());
+		std::unique_ptr<GameSounds> sounds;
+		std::unique_ptr<AssetLoader> assets(new AssetLoader(*jobs, *files));
+
+		// Workers steal the oldest jobs first, so queue the slowest one
+		// (audio device + BGM decode) ahead of the rest.
+		const AudioConfig audioConfig = options.audio;
+		AssetFileSystem* soundFiles = files.get();
+		assets->Run([&sounds, audioConfig, soundFiles]() { sounds.reset(new GameSounds(audioConfig, *soundFiles)); });
+
+		GameFont::Prefetch(*assets);
+		Block::Prefetch(*assets);
+		GpuScene::Prefetch(*assets);
+		assets->PrefetchFile(VERT_SHADER_PATH);
+		assets->PrefetchFile(FRAG_SHADER_PATH);
+
 		device = new Vk::Device(window);
 		swapChain = new Vk::SwapChain(*device, window.getExtent());
+		pipelines = new PipelineRegistry(*device, *assets);
 
-		CreateDescriptorSetLayout();
 		CreateUniformBuffer();
-		CreateDescriptorPool();
+		CreateDescriptors();
+
+		// Blocks on the baked bitmaps, then uploads them.
+		std::unique_ptr<GameFont> font(new GameFont(*device, *bindless, *swapChain, *assets, *pipelines));
 
-		auto* font = new GameFont(*device, descriptorPool, *swapChain);
+		assets->Wait();
+		auto* flashText = new FlashText(*font, *swapChain);
 		context = new GameContext(
 			device,
-			new GameSounds(),
-			font,
+			files.release(),
+			jobs.release(),
+			assets.release(),
+			sounds.release(),
+			font.release(),
 			new GameCamera(),
-			new FlashText(*font, *swapChain));
+			flashText);
+		context->vertexFormat = options.vertexFormat;
+		DebugLog(std::string("Mesh vertex format: ") + GetVertexFormatName(context->vertexFormat));
 
-		CreateDescriptorSet();
 		CreatePipelineLayout();
+
+		// Registers its buffers in the bindless set, so before anything is
+		// recorded.
+		if(options.gpuDriven && device->supportsIndirectCount()) {
+			gpuScene = new GpuScene(*device, *bindless, *context->assets, Block::GetMesh(*context->assets), context->vertexFormat);
+			gpuScene->Resize(swapChain->imageCount());
+			DebugLog("Blocks are culled and drawn on the GPU.");
+		}
+		else if(options.gpuDriven) DebugLog("No indirect count draws on this device, culling blocks on the CPU.");
+
 		CreatePipeline();
 		CreateGameEntities();
+		CreateCommandPools();
 
-		font->CreateVertexBuffer();
+		const auto startupTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startupBegin);
+		DebugLog("Startup took " + std::to_string(startupTime.count()) + " ms.");
 	}
 
 	Game::~Game() {
 		DebugLog("Destroying game entities.");
+		for(auto& pending : destructionQueue) delete pending.entity;
+		destructionQueue.clear();
+
 		DestroyPtrs<Block>  (blocks);
 		DestroyPtrs<Loot>   (loots);
 		DestroyPtrs<Wall>   (walls);
@@ -65,11 +158,13 @@ namespace Paddle {
 		DestroyPtr<PlayerPaddle>(paddle);
 
 		DebugLog("Destroying Vulkan resources.");
-		vkFreeCommandBuffers(device->device(), device->getCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+		FreeCommandBuffers();
+		for(auto pool : recordPools)
+			vkDestroyCommandPool(device->device(), pool, nullptr);
 		vkDestroyBuffer(device->device(), cameraUbo, nullptr);
 		vkFreeMemory(device->device(), cameraUboMemory, nullptr);
-		vkDestroyDescriptorPool(device->device(), descriptorPool, nullptr);
-		vkDestroyDescriptorSetLayout(device->device(), descriptorSetLayout, nullptr);
+		DestroyPtr<GpuScene>(gpuScene);
+		DestroyPtr<Vk::BindlessDescriptors>(bindless);
 		vkDestroyPipelineLayout(device->device(), pipelineLayout, nullptr);
 
 		DebugLog("Destroying game resources.");
@@ -77,10 +172,14 @@ namespace Paddle {
 		DestroyPtr<GameCamera>  (context->camera);
 		DestroyPtr<GameFont>    (context->font);
 		DestroyPtr<FlashText>   (context->fm);
+		DestroyPtr<AssetLoader> (context->assets);
+		context->jobs->Wait(traceExports); // Lets an F9 trace finish writing
+		DestroyPtr<JobSystem>   (context->jobs);
+		DestroyPtr<AssetFileSystem> (context->files);
 		DestroyPtr<GameContext> (context);
 
 		DebugLog("Destroying Vulkan objects.");
-		DestroyPtr<Vk::Pipeline>(pipeline);
+		DestroyPtr<PipelineRegistry>(pipelines);
 		DestroyPtr<Vk::SwapChain>(swapChain);
 		DestroyPtr<Vk::Device>(device);
 	}
@@ -110,17 +209,18 @@ namespace Paddle {
 		EntityAddDeltaPos(ball->AsEntity(), delta);
 	}
 
-	void Game::ResetGame(uint64_t currentFrame) {
+	void Game::ResetGame(uint64_t frameNumber) {
 		DebugLog("Resetting game state.");
 
-		ResetEntities(currentFrame);
+		ResetEntities(frameNumber);
 		context->score = 0;
 		context->gameOver = false;
 	}
 
 	template <typename T>
-	void Game::UpdateDestructionQueue(std::vector<T*>& entities, uint64_t currentFrame, bool deleteAll) {
+	void Game::UpdateDestructionQueue(std::vector<T*>& entities, uint64_t frameNumber, bool deleteAll) {
 		static_assert(std::is_base_of<GameEntity, T>::value, "T must be a GameEntity");
+		PROFILE_SCOPE("Destruction queue");
 
 		for(auto it = entities.begin(); it != entities.end(); ) {
 			GameEntity* entity = *it;
@@ -130,7 +230,7 @@ namespace Paddle {
 
 			if(shouldDelete) {
 				DebugLog(std::string(typeid(*entity).name()) + " marked fordestruction");
-				PendingDestroyEntity pd{ entity->AsEntity(), currentFrame + MAX_FRAMES_IN_FLIGHT };
+				PendingDestroyEntity pd{ entity->AsEntity(), frameNumber };
 				destructionQueue.push_back(pd);
 				it = entities.erase(it);
 			}
@@ -138,7 +238,7 @@ namespace Paddle {
 		}
 	}
 
-	void Game::ResetEntities(uint64_t currentFrame) {
+	void Game::ResetEntities(uint64_t frameNumber) {
 		DebugLog("Resetting game entities.");
 
 		context->camera->Reset();
@@ -146,9 +246,9 @@ namespace Paddle {
 		ball->Reset();
 		for(auto& wall : walls) wall->Reset();
 
-		UpdateDestructionQueue<Block>(blocks, currentFrame, true);
-		UpdateDestructionQueue<Loot>(loots, currentFrame, true);
-		UpdateDestructionQueue<Bullet>(bullets, currentFrame, true);
+		UpdateDestructionQueue<Block>(blocks, frameNumber, true);
+		UpdateDestructionQueue<Loot>(loots, frameNumber, true);
+		UpdateDestructionQueue<Bullet>(bullets, frameNumber, true);
 
 		Block::CreateBlocks(*context, blocks, loots);
 	}
@@ -193,14 +293,30 @@ namespace Paddle {
 		context->font->AddText(FontFamily::FONT_FAMILY_BODY, "Press Space to restart. Esc to exit.", -153.0f * scaleX, 150.0f * scaleY, 0.25f * scaleX, glm::vec3(112.0f / 255.0f));
 	}
 
+	// Sleep granularity on Windows is coarse, so only sleep while the deadline
+	// is comfortably far away and yield for the last stretch.
+	static void WaitUntil(std::chrono::steady_clock::time_point deadline) {
+		PROFILE_SCOPE("Wait for tick");
+		while(true) {
+			const auto now = std::chrono::steady_clock::now();
+			if(now >= deadline) return;
+
+			if(deadline - now > std::chrono::milliseconds(2))
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			else std::this_thread::yield();
+		}
+	}
+
 	void Game::run() {
 		srand(static_cast<unsigned int>(time(0)));
-		uint64_t currentFrame = 0, absoluteFrameNumber = 0;
+		uint64_t absoluteFrameNumber = 0;
 
 		context->gameSounds->PlayBgm();
 
 		bool prevPlayPaddleCollisionSound = false;
 		bool prevF10Pressed = false;
+		bool prevF9Pressed = false;
+		uint32_t traceCount = 0;
 		bool prevGameOver = false;
 		int prevScore = -1;
 		glm::vec3 paddleMoveDelta = glm::vec3(0.0f);
@@ -214,12 +330,22 @@ namespace Paddle {
 		uint32_t streak_count = 0;
 		std::string livesText;
 
-		swapChain->recreate();
-		CreatePipeline();
-		context->font->CreatePipeline();
-		CreateCommandBuffers();
+		RecreateSwapChainResources();
+
+		//
+		// Input and simulation stay on this thread (GLFW wants the main
+		// thread), everything Vulkan moves to the render thread.
+		//
+		renderThreadRunning = true;
+		renderThread = std::thread(&Game::RenderLoop, this);
+
+		auto nextTick = std::chrono::steady_clock::now();
+
+		while (!window.ShouldClose() && !renderThreadFailed) {
+			WaitUntil(nextTick);
+			nextTick = std::max(nextTick, std::chrono::steady_clock::now()) + SIM_TICK_DURATION;
+			PROFILE_SCOPE("Simulation tick");
 
-		while (!window.ShouldClose()) {
 			window.PollEvents();
 
 			context->fm->Update();
@@ -227,15 +353,22 @@ namespace Paddle {
 			//
 			// Cleanup pending destroys
 			//
-			currentFrame = absoluteFrameNumber % MAX_FRAMES_IN_FLIGHT;
-
-			for(auto it = destructionQueue.begin(); it != destructionQueue.end(); ) {
-				if(it->frameNumber <= absoluteFrameNumber) {
-					DebugLog("Destroying entity: " + std::string(typeid(*it->entity).name()));
-					delete it->entity;
-					it = destructionQueue.erase(it);
+			{
+				PROFILE_SCOPE("Destruction sweep");
+				const uint64_t retiredFrame = gpuRetiredFrame.load(std::memory_order_acquire);
+
+				for(auto it = destructionQueue.begin(); it != destructionQueue.end(); ) {
+					if(it->frameNumber <= retiredFrame) {
+						DebugLog("Destroying entity: " + std::string(typeid(*it->entity).name()));
+						delete it->entity;
+						it = destructionQueue.erase(it);
+
+						// Cached command buffers may still reference its buffers.
+						++resourceEpoch;
+					}
+					else ++it;
 				}
-				else ++it;
+				PROFILE_COUNTER("Pending destroys", destructionQueue.size());
 			}
 
 			++absoluteFrameNumber;
@@ -252,15 +385,29 @@ namespace Paddle {
 			bool f10Pressed = window.IsKeyPressed(GLFW_KEY_F10);
 			if(f10Pressed && !prevF10Pressed) {
 				window.ToggleFullscreen();
-				swapChain->recreate();
-				CreatePipeline();
-				context->font->CreatePipeline();
-				CreateCommandBuffers();
+				RequestSwapChainRecreate();
 			}
 
+			//
+			// Trace of the last few seconds
+			//
+			bool f9Pressed = window.IsKeyPressed(GLFW_KEY_F9);
+			if(f9Pressed && !prevF9Pressed) {
+				// Only the ring copy happens here, formatting and disk I/O
+				// would stall the tick.
+				const std::string path = "paddle-trace-" + std::to_string(++traceCount) + ".json";
+				auto capture = Profiler::CaptureTrace(traceWindowSeconds);
+				if(capture) {
+					context->jobs->Submit([capture, path]() {
+						if(!Profiler::WriteTrace(*capture, path)) DebugLog("Failed to write trace " + path);
+					}, &traceExports);
+				}
+			}
+			prevF9Pressed = f9Pressed;
+
 			if(waitingForBlockReset) {
 				if(difftime(time(NULL), blockResetTime) >= 1) {
-					ResetEntities(currentFrame);
+					ResetEntities(absoluteFrameNumber);
 					waitingForBlockReset = false;
 				}
 			}
@@ -313,57 +460,68 @@ namespace Paddle {
 				for(auto& bullet : bullets) bullet->Update();
 			}
 
+			//
+			// Block animation
+			//
+			{
+				PROFILE_SCOPE("Block update");
+				context->jobs->ParallelFor(static_cast<uint32_t>(blocks.size()), BLOCK_UPDATE_GRAIN, [this](uint32_t begin, uint32_t end) {
+					for(uint32_t i = begin; i < end; ++i) blocks[i]->Update();
+				});
+			}
+
 			//
 			// Block Collision
 			//
 			bool didBlockCollide = false;
-			for(auto& block : blocks) {
-				block->Update();
-
-				bool didBulletCollide = false;
-				for(auto& bullet : bullets) {
-					if(bullet->CheckCollision(block)) {
-						DebugLog("Bullet collision with block detected");
-						didBulletCollide = true;
-						bullet->MarkForDestruction();
-						break;
-					}
-				}
-
-				if(block->IsExploded()) {
-					block->MarkForDestruction();
-
-					//
-					// Reset blocks
-					//
-					bool isAllBlocksBroken = true;
-					for(auto& b : blocks) {
-						if(!b->IsMarkedForDestruction() || !b->IsExplosionInitiated()) {
-							isAllBlocksBroken = false;
+			{
+				PROFILE_SCOPE("Block collisions");
+				for(auto& block : blocks) {
+					bool didBulletCollide = false;
+					for(auto& bullet : bullets) {
+						if(bullet->CheckCollision(block)) {
+							DebugLog("Bullet collision with block detected");
+							didBulletCollide = true;
+							bullet->MarkForDestruction();
 							break;
 						}
 					}
 
-					if(isAllBlocksBroken && !waitingForBlockReset) {
-						waitingForBlockReset = true;
-						blockResetTime = time(NULL);
-						context->gameSounds->PlaySfx(SFX_BLOCKS_RESET);
-					}
-				}
-				else if(!block->IsExplosionInitiated() && (ball->CheckCollision(block) || didBulletCollide)) {
-					didBlockCollide = true;
-					ball->OnCollision(block);
-					block->InitExplosion();
-
-					if(difftime(time(NULL), lastCollision) < 2) {
-						++streak_count;
-						DebugLog("Streak bonus: " + std::to_string(streak_count));
+					if(block->IsExploded()) {
+						block->MarkForDestruction();
+
+						//
+						// Reset blocks
+						//
+						bool isAllBlocksBroken = true;
+						for(auto& b : blocks) {
+							if(!b->IsMarkedForDestruction() || !b->IsExplosionInitiated()) {
+								isAllBlocksBroken = false;
+								break;
+							}
+						}
+
+						if(isAllBlocksBroken && !waitingForBlockReset) {
+							waitingForBlockReset = true;
+							blockResetTime = time(NULL);
+							context->gameSounds->PlaySfx(SFX_BLOCKS_RESET);
+						}
 					}
+					else if(!block->IsExplosionInitiated() && (ball->CheckCollision(block) || didBulletCollide)) {
+						didBlockCollide = true;
+						ball->OnCollision(block);
+						block->InitExplosion();
+
+						if(difftime(time(NULL), lastCollision) < 2) {
+							++streak_count;
+							DebugLog("Streak bonus: " + std::to_string(streak_count));
+						}
 
-					time(&lastCollision);
+						time(&lastCollision);
 
-					context->gameSounds->PlaySfx(SFX_BLOCK_EXPLOSION);
-					context->score += 10;
+						context->gameSounds->PlaySfx(SFX_BLOCK_EXPLOSION);
+						context->score += 10;
+					}
 				}
 			}
 
@@ -381,45 +539,49 @@ namespace Paddle {
 
 			std::string scoreText = "Score: " + std::to_string(context->score);
 
-			//
-			// Paddle Collision
-			//
 			bool playPaddleCollisionSound = false;
-			if(ball->CheckCollision(paddle->AsEntity())) {
-				DebugLog("Ball collision with paddle detected.");
-				ball->OnCollision(paddle->AsEntity());
+			{
+				PROFILE_SCOPE("Paddle, loot and wall collisions");
 
-				if(!prevPlayPaddleCollisionSound)
-					context->gameSounds->PlaySfx(SFX_PADDLE_BOUNCE);
-				playPaddleCollisionSound = true;
-			}
+				//
+				// Paddle Collision
+				//
+				if(ball->CheckCollision(paddle->AsEntity())) {
+					DebugLog("Ball collision with paddle detected.");
+					ball->OnCollision(paddle->AsEntity());
 
-			//
-			// Loot Collision
-			//
-			for(auto& loot : loots) {
-				if(loot->CheckCollision(paddle->AsEntity())) {
-					DebugLog("Loot collision with paddle detected.");
-					loot->OnCollision();
-					loot->MarkForDestruction();
+					if(!prevPlayPaddleCollisionSound)
+						context->gameSounds->PlaySfx(SFX_PADDLE_BOUNCE);
+					playPaddleCollisionSound = true;
 				}
-			}
 
-			//
-			// Wall collision
-			//
-			for(auto& wall : walls) {
-				for(auto& bullet : bullets) {
-					if(bullet->CheckCollision(wall)) {
-						DebugLog("Bullet collision with wall detected");
-						bullet->MarkForDestruction();
+				//
+				// Loot Collision
+				//
+				for(auto& loot : loots) {
+					if(loot->CheckCollision(paddle->AsEntity())) {
+						DebugLog("Loot collision with paddle detected.");
+						loot->OnCollision();
+						loot->MarkForDestruction();
 					}
 				}
 
-				if(ball->CheckCollision(wall)) {
-					DebugLog("Ball collision with wall detected.");
-					ball->OnCollision(wall);
-					context->gameSounds->PlaySfx(SFX_WALL_BOUNCE);
+				//
+				// Wall collision
+				//
+				for(auto& wall : walls) {
+					for(auto& bullet : bullets) {
+						if(bullet->CheckCollision(wall)) {
+							DebugLog("Bullet collision with wall detected");
+							bullet->MarkForDestruction();
+						}
+					}
+
+					if(ball->CheckCollision(wall)) {
+						DebugLog("Ball collision with wall detected.");
+						ball->OnCollision(wall);
+						context->gameSounds->PlaySfx(SFX_WALL_BOUNCE);
+					}
 				}
 			}
 
@@ -475,11 +637,11 @@ namespace Paddle {
 					context->gameSounds->PlayBgm();
 					context->gameSounds->PlaySfx(SFX_BLOCKS_RESET);
 
-					ResetGame(currentFrame);
+					ResetGame(absoluteFrameNumber);
 					context->font->ClearText();
 					RenderScoreFont(scoreText, livesText);
 					context->fm->Draw();
-					context->font->CreateVertexBuffer();
+					PublishSnapshot(absoluteFrameNumber);
 					prevScore = context->score;
 					prevGameOver = context->gameOver;
 					continue;
@@ -493,8 +655,6 @@ namespace Paddle {
 				context->fm->Draw();
 			}
 
-			context->font->CreateVertexBuffer();
-
 			if(prevScore != context->score || prevGameOver != context->gameOver || prevF10Pressed != f10Pressed) {
 				if(prevGameOver != context->gameOver) {
 					context->gameSounds->PauseBgm();
@@ -509,27 +669,138 @@ namespace Paddle {
 			//
 			// Move entites to destruction queue
 			//
-			UpdateDestructionQueue<Block> (blocks, currentFrame);
-			UpdateDestructionQueue<Loot>  (loots, currentFrame);
-			UpdateDestructionQueue<Bullet>(bullets, currentFrame);
-
-			CreateCommandBuffers();
-			DrawFrame();
+			UpdateDestructionQueue<Block> (blocks, absoluteFrameNumber);
+			UpdateDestructionQueue<Loot>  (loots, absoluteFrameNumber);
+			UpdateDestructionQueue<Bullet>(bullets, absoluteFrameNumber);
+
+#if PADDLE_PROFILER
+			// Trigger to audible so far, shown next to the frames that caused
+			// it, and the device buffer it includes.
+			const AudioLatencyStats latency = context->gameSounds->GetLatencyStats();
+			PROFILE_COUNTER("Audio buffer (us)", latency.bufferLatencyMs * 1000.0f);
+			PROFILE_COUNTER("Sfx output latency avg (us)", latency.averageOutputLatencyMs * 1000.0f);
+			PROFILE_COUNTER("Sfx output latency max (us)", latency.maxOutputLatencyMs * 1000.0f);
+#endif
+
+			PublishSnapshot(absoluteFrameNumber);
 		}
 
+		renderThreadRunning = false;
+		renderThread.join();
 		vkDeviceWaitIdle(device->device());
+
+		if(!tracePath.empty() && !Profiler::WriteTrace(tracePath, 0.0)) DebugLog("Failed to write trace " + tracePath);
+
+		if(renderThreadError) std::rethrow_exception(renderThreadError);
+	}
+
+	void Game::PublishSnapshot(uint64_t frameNumber) {
+		PROFILE_SCOPE("Publish snapshot");
+		auto& snapshot = snapshots.WriteBuffer();
+		snapshot.frameNumber    = frameNumber;
+		snapshot.resourceEpoch  = resourceEpoch;
+		snapshot.cameraPosition = context->camera->GetPosition();
+		snapshot.cameraTarget   = context->camera->GetTarget();
+
+		// clear() keeps capacity, the recycled snapshot doesn't reallocate.
+		for(auto& commands : snapshot.drawCommands) commands.clear();
+		snapshot.blockInstances.clear();
+
+		// Same matrices the render thread will upload for this snapshot.
+		const float aspect = static_cast<float>(swapChain->width()) / static_cast<float>(swapChain->height());
+		const CameraUbo camera = GameCamera::MakeUbo(snapshot.cameraPosition, snapshot.cameraTarget, aspect);
+
+		DrawView view;
+		view.cameraPosition = snapshot.cameraPosition;
+		view.pixelsPerUnit  = static_cast<float>(swapChain->height()) / (2.0f * std::tan(glm::radians(CAMERA_FOV_Y) * 0.5f));
+		view.frustum        = Frustum::FromViewProjection(camera.proj * camera.view);
+		snapshot.view       = view;
+
+		if(gpuScene) {
+			for(auto& block : blocks) block->CollectInstances(snapshot.blockInstances);
+		}
+		else {
+			for(auto& block : blocks) block->CollectDrawCommands(view, snapshot.drawCommands[DRAW_CATEGORY_BLOCKS]);
+		}
+		ball->CollectDrawCommands(view, snapshot.drawCommands[DRAW_CATEGORY_BALL]);
+		for(auto& loot : loots)     loot->CollectDrawCommands(view, snapshot.drawCommands[DRAW_CATEGORY_LOOTS]);
+		for(auto& bullet : bullets) bullet->CollectDrawCommands(view, snapshot.drawCommands[DRAW_CATEGORY_BULLETS]);
+
+		context->font->CopyText(snapshot.text);
+		PROFILE_COUNTER("Block draws", gpuScene ? snapshot.blockInstances.size() : snapshot.drawCommands[DRAW_CATEGORY_BLOCKS].size());
+
+		snapshots.Publish();
+	}
+
+	void Game::RequestSwapChainRecreate() {
+		recreateRequested = true;
+
+		// The simulation lays text out against the swapchain extent, so hold
+		// it until the render thread is done. Keep pumping the window while
+		// waiting, the mode switch may need it.
+		while(recreateRequested && !renderThreadFailed) {
+			window.PollEvents();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	//
+	// Render thread
+	//
+
+	void Game::RenderLoop() {
+		PROFILE_THREAD("Render");
+		try {
+			while(renderThreadRunning) {
+				if(recreateRequested) {
+					RecreateSwapChainResources();
+					recreateRequested = false;
+					continue;
+				}
+
+				// Nothing new from the simulation, don't redraw the same frame.
+				if(!snapshots.Consume()) {
+					std::this_thread::sleep_for(std::chrono::microseconds(500));
+					continue;
+				}
+
+				DrawFrame(snapshots.ReadBuffer());
+			}
+		}
+		catch(...) {
+			renderThreadError = std::current_exception();
+			renderThreadFailed = true;
+		}
+	}
+
+	void Game::RecreateSwapChainResources() {
+		PROFILE_SCOPE("Recreate swapchain");
+		swapChain->recreate();
+
+		// Every variant was built against the old render pass.
+		pipelines->Clear();
+		CreatePipeline();
+		context->font->CreatePipeline();
+		if(gpuScene) gpuScene->Resize(swapChain->imageCount());
+		CreateCommandBuffers();
+
+		// recreate() idles the device, everything submitted so far is done.
+		inFlightSnapshotFrames.fill(lastSubmittedFrame);
+		gpuRetiredFrame.store(lastSubmittedFrame, std::memory_order_release);
+		hasUploadedCamera = false;
 	}
 
 	void Game::CreatePipelineLayout() {
 		VkPushConstantRange pushConstantRange{};
 		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(glm::mat4);
+		pushConstantRange.size = sizeof(MeshPushConstants);
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		const VkDescriptorSetLayout setLayout = bindless->GetLayout();
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -538,48 +809,21 @@ namespace Paddle {
 		}
 	}
 
-	static VkVertexInputBindingDescription getBindingDescription() {
-		VkVertexInputBindingDescription bindingDescription{};
-		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
-		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-		return bindingDescription;
-	}
-
-	static std::array<VkVertexInputAttributeDescription, 4> getAttributeDescriptions() {
-		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
-		attributeDescriptions[0].binding  = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset   = offsetof(Vertex, pos);
-
-		attributeDescriptions[1].binding  = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset   = offsetof(Vertex, color);
-
-		attributeDescriptions[2].binding  = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format   = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[2].offset   = offsetof(Vertex, normal);
-
-		attributeDescriptions[3].binding  = 0;
-		attributeDescriptions[3].location = 3;
-		attributeDescriptions[3].format   = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[3].offset   = offsetof(Vertex, uv);
-
-		return attributeDescriptions;
-	}
-
 	void Game::CreatePipeline() {
-		DestroyPtr<Vk::Pipeline>(pipeline);
-
 		auto pipelineConfig = Vk::Pipeline::DefaultPipelineConfigInfo(swapChain->width(), swapChain->height());
 		pipelineConfig.renderPass = swapChain->getRenderPass();
 		pipelineConfig.pipelineLayout = pipelineLayout;
 
-		static auto bindingDescription = getBindingDescription();
-		static auto attributeDescriptions = getAttributeDescriptions();
+		const glm::vec3 direction = shading.directionToLight;
+		pipelineConfig.specialization.Set(SHADER_CONSTANT_LIGHT_DIRECTION_X, direction.x);
+		pipelineConfig.specialization.Set(SHADER_CONSTANT_LIGHT_DIRECTION_Y, direction.y);
+		pipelineConfig.specialization.Set(SHADER_CONSTANT_LIGHT_DIRECTION_Z, direction.z);
+		pipelineConfig.specialization.Set(SHADER_CONSTANT_AMBIENT, shading.ambient);
+		pipelineConfig.specialization.Set(SHADER_CONSTANT_LIGHTING, shading.lighting);
+
+		// Must outlive the pipeline creation below.
+		const auto bindingDescription = GetVertexBindingDescription(context->vertexFormat);
+		const auto attributeDescriptions = GetVertexAttributeDescriptions(context->vertexFormat);
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		vertexInputInfo.vertexBindingDescriptionCount = 1;
@@ -587,14 +831,25 @@ namespace Paddle {
 		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
 		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 		pipelineConfig.vertexInputInfo = vertexInputInfo;
-		pipeline = new Vk::Pipeline(
-			*device,
-			"Shader\\shader.vert.spv",
-			"Shader\\shader.frag.spv",
-			pipelineConfig);
+		pipeline = pipelines->Get(VERT_SHADER_PATH, FRAG_SHADER_PATH, pipelineConfig);
+
+		if(gpuScene) {
+			pipelineConfig.specialization.Set(SHADER_CONSTANT_GPU_DRIVEN, true);
+			indirectPipeline = pipelines->Get(VERT_SHADER_PATH, FRAG_SHADER_PATH, pipelineConfig);
+		}
+	}
+
+	void Game::CreateCommandPools() {
+		for(auto& pool : recordPools)
+			pool = device->CreateCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 	}
 
 	void Game::CreateCommandBuffers() {
+		FreeCommandBuffers();
+
+		//
+		// Primary buffers, re-recorded every frame
+		//
 		commandBuffers.resize(swapChain->imageCount());
 
 		VkCommandBufferAllocateInfo allocInfo{};
@@ -607,64 +862,183 @@ namespace Paddle {
 			throw std::runtime_error("failed to allocate command buffers");
 		}
 
-		for(int i = 0; i < commandBuffers.size(); i++) {
-			VkCommandBufferBeginInfo beginInfo{};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		//
+		// Secondary buffers, one per draw category per image
+		//
+		secondaryCommandBuffers.resize(swapChain->imageCount());
+		for(auto& perImage : secondaryCommandBuffers) {
+			for(size_t category = 0; category < DRAW_CATEGORY_COUNT; ++category) {
+				VkCommandBufferAllocateInfo secondaryAllocInfo{};
+				secondaryAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				secondaryAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				secondaryAllocInfo.commandPool = recordPools[category];
+				secondaryAllocInfo.commandBufferCount = 1;
+
+				if(vkAllocateCommandBuffers(device->device(), &secondaryAllocInfo, &perImage[category].commandBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("failed to allocate secondary command buffers");
+				}
+				perImage[category].valid = false;
+			}
+		}
+	}
+
+	void Game::FreeCommandBuffers() {
+		if(!commandBuffers.empty()) {
+			vkFreeCommandBuffers(device->device(), device->getCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+			commandBuffers.clear();
+		}
 
-			if(vkBeginCommandBuffer(commandBuffers[i], &beginInfo) != VK_SUCCESS) {
-				throw std::runtime_error("failed to begin recording command buffer");
+		for(auto& perImage : secondaryCommandBuffers) {
+			for(size_t category = 0; category < DRAW_CATEGORY_COUNT; ++category) {
+				if(perImage[category].commandBuffer == VK_NULL_HANDLE) continue;
+				vkFreeCommandBuffers(device->device(), recordPools[category], 1, &perImage[category].commandBuffer);
 			}
+		}
+		secondaryCommandBuffers.clear();
+	}
 
-			VkRenderPassBeginInfo renderPassInfo{};
-			renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassInfo.renderPass  = swapChain->getRenderPass();
-			renderPassInfo.framebuffer = swapChain->getFrameBuffer(i);
+	VkCommandBufferInheritanceInfo Game::GetInheritanceInfo(uint32_t imageIndex) {
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass  = swapChain->getRenderPass();
+		inheritanceInfo.subpass     = 0;
+		inheritanceInfo.framebuffer = swapChain->getFrameBuffer(imageIndex);
+		return inheritanceInfo;
+	}
 
-			renderPassInfo.renderArea.offset = { 0, 0 };
-			renderPassInfo.renderArea.extent = swapChain->getSwapChainExtent();
+	void Game::RecordSecondaryCommandBuffer(uint32_t imageIndex, DrawCategory category, const RenderSnapshot& snapshot) {
+		PROFILE_SCOPE(DRAW_CATEGORY_ZONE_NAMES[category]);
+		auto& secondary = secondaryCommandBuffers[imageIndex][category];
+		const VkCommandBufferInheritanceInfo inheritanceInfo = GetInheritanceInfo(imageIndex);
 
-			std::array<VkClearValue, 2> clearValues{};
-			clearValues[0].color        = { 0.07f, 0.09f, 0.13f, 1.0f }; // #121724
-			clearValues[1].depthStencil = { 1.0f, 0 };
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
 
-			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-			renderPassInfo.pClearValues    = clearValues.data();
+		if(vkBeginCommandBuffer(secondary.commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording secondary command buffer");
+		}
 
-			vkCmdBeginRenderPass(commandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		if(category == DRAW_CATEGORY_TEXT) {
+			context->font->Draw(secondary.commandBuffer, imageIndex);
+		}
+		else if(category == DRAW_CATEGORY_BLOCKS && gpuScene) {
+			// Draw count and commands come from this frame's culling pass,
+			// so this is recorded once and never goes stale.
+			indirectPipeline->bind(secondary.commandBuffer);
+			bindless->Bind(secondary.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+			gpuScene->RecordDraw(secondary.commandBuffer, imageIndex, pipelineLayout);
+		}
+		else if(!snapshot.drawCommands[category].empty()) {
+			pipeline->bind(secondary.commandBuffer);
+			bindless->Bind(secondary.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout);
+			GameEntity::RecordDrawCommands(secondary.commandBuffer, pipelineLayout, snapshot.drawCommands[category]);
+		}
 
-			pipeline->bind(commandBuffers[i]);
+		if(vkEndCommandBuffer(secondary.commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record secondary command buffer");
+		}
+	}
 
-			//
-			// Draw all entities
-			//
+	void Game::RecordCommandBuffer(uint32_t imageIndex, const RenderSnapshot& snapshot) {
+		PROFILE_SCOPE("Record command buffers");
+		//
+		// Re-record only the categories that changed since this image last used them
+		//
+		const uint64_t fontVersion = context->font->GetVersion(imageIndex);
+		JobCounter recordCounter;
+		uint32_t rerecordedCount = 0;
+		for(int category = 0; category < DRAW_CATEGORY_COUNT; ++category) {
+			auto& secondary = secondaryCommandBuffers[imageIndex][category];
+
+			const bool isStale = !secondary.valid ||
+				secondary.recordedResourceEpoch != snapshot.resourceEpoch ||
+				(category == DRAW_CATEGORY_TEXT ? secondary.recordedFontVersion != fontVersion
+				                                : secondary.recordedCommands != snapshot.drawCommands[category]);
+			if(!isStale) continue;
+
+			secondary.valid                 = true;
+			secondary.recordedResourceEpoch = snapshot.resourceEpoch;
+			secondary.recordedFontVersion   = fontVersion;
+			secondary.recordedCommands      = snapshot.drawCommands[category];
+
+			++rerecordedCount;
+			const DrawCategory drawCategory = static_cast<DrawCategory>(category);
+			context->jobs->Submit([this, imageIndex, drawCategory, &snapshot]() {
+				RecordSecondaryCommandBuffer(imageIndex, drawCategory, snapshot);
+			}, &recordCounter);
+		}
 
-			for(auto& block : blocks)
-				block->Draw(commandBuffers[i], pipelineLayout, cameraDescriptorSet);
+		context->jobs->Wait(recordCounter);
+		PROFILE_COUNTER("Secondaries recorded", rerecordedCount);
 
-			ball->Draw(commandBuffers[i], pipelineLayout, cameraDescriptorSet);
+		//
+		// Primary buffer culls, clears and executes the secondaries
+		//
+		VkCommandBuffer commandBuffer = commandBuffers[imageIndex];
 
-			for(auto& loot : loots)
-				loot->Draw(commandBuffers[i], pipelineLayout, cameraDescriptorSet);
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-			for(auto& bullet : bullets)
-				bullet->Draw(commandBuffers[i], pipelineLayout, cameraDescriptorSet);
+		if(vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording command buffer");
+		}
 
-			context->font->Draw(commandBuffers[i]);
+		// Writes the indirect draws the blocks' secondary reads.
+		if(gpuScene) gpuScene->RecordCulling(commandBuffer, imageIndex, snapshot.view);
 
-			vkCmdEndRenderPass(commandBuffers[i]);
-			if(vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
-				throw std::runtime_error("failed to record command buffer");
-			}
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass  = swapChain->getRenderPass();
+		renderPassInfo.framebuffer = swapChain->getFrameBuffer(imageIndex);
+
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = swapChain->getSwapChainExtent();
+
+		std::array<VkClearValue, 2> clearValues{};
+		clearValues[0].color        = { 0.07f, 0.09f, 0.13f, 1.0f }; // #121724
+		clearValues[1].depthStencil = { 1.0f, 0 };
+
+		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassInfo.pClearValues    = clearValues.data();
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		std::array<VkCommandBuffer, DRAW_CATEGORY_COUNT> secondaries;
+		for(size_t category = 0; category < DRAW_CATEGORY_COUNT; ++category)
+			secondaries[category] = secondaryCommandBuffers[imageIndex][category].commandBuffer;
+		vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+
+		vkCmdEndRenderPass(commandBuffer);
+		if(vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record command buffer");
 		}
 	}
 
-	void Game::DrawFrame() {
+	void Game::DrawFrame(const RenderSnapshot& snapshot) {
+		PROFILE_SCOPE("Draw frame");
 		uint32_t imageIndex;
 		auto result = swapChain->acquireNextImage(&imageIndex);
 		if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
 			throw std::runtime_error("failed to acquire swap chain image");
 		}
-		UpdateUniformBuffer(imageIndex);
+
+		// Acquire waited on this frame slot's fence, so whatever it carried
+		// last (and everything queued before it) has finished on the GPU.
+		const size_t frameSlot = swapChain->getCurrentFrame();
+		gpuRetiredFrame.store(inFlightSnapshotFrames[frameSlot], std::memory_order_release);
+
+		// The image's previous submission must retire before its buffers are touched.
+		swapChain->waitForImage(imageIndex);
+		context->font->UploadText(imageIndex, snapshot.text);
+		if(gpuScene) gpuScene->UploadInstances(imageIndex, snapshot.blockInstances);
+		RecordCommandBuffer(imageIndex, snapshot);
+
+		UpdateUniformBuffer(snapshot);
+		inFlightSnapshotFrames[frameSlot] = snapshot.frameNumber;
+		lastSubmittedFrame = snapshot.frameNumber;
 		result = swapChain->submitCommandBuffers(&commandBuffers[imageIndex], &imageIndex);
 		if(result != VK_SUCCESS) {
 			throw std::runtime_error("failed to present swap chain image");
@@ -681,15 +1055,21 @@ namespace Paddle {
 			cameraUboMemory);
 	}
 
-	void Game::UpdateUniformBuffer(uint32_t currentImage) {
-		CameraUbo ubo{};
-		glm::vec3 camPos    = context->camera->GetPosition();
-		glm::vec3 camTarget = context->camera->GetTarget();
-		ubo.view = glm::lookAt(camPos, camTarget, glm::vec3(0.0f, 0.0f, 1.0f));
-
+	void Game::UpdateUniformBuffer(const RenderSnapshot& snapshot) {
 		float aspect = float(swapChain->width()) / float(swapChain->height());
-		ubo.proj = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 10.0f);
-		ubo.proj[1][1] *= -1;
+		const CameraUbo ubo = GameCamera::MakeUbo(snapshot.cameraPosition, snapshot.cameraTarget, aspect);
+
+		// Every frame in flight reads this one buffer. The camera only moves
+		// on reset or resize, so wait for the queue on the rare change rather
+		// than overwrite it under a frame that's still rendering.
+		if(hasUploadedCamera && memcmp(&ubo, &uploadedCameraUbo, sizeof(ubo)) == 0) return;
+		if(hasUploadedCamera) {
+			PROFILE_SCOPE("Camera queue wait");
+			vkQueueWaitIdle(device->graphicsQueue());
+		}
+
+		uploadedCameraUbo = ubo;
+		hasUploadedCamera = true;
 
 		void* data;
 		vkMapMemory(device->device(), cameraUboMemory, 0, sizeof(ubo), 0, &data);
@@ -697,80 +1077,10 @@ namespace Paddle {
 		vkUnmapMemory(device->device(), cameraUboMemory);
 	}
 
-	void Game::CreateDescriptorSet() {
-		VkDescriptorSetAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = descriptorPool;
-		allocInfo.descriptorSetCount = 1;
-		allocInfo.pSetLayouts = &descriptorSetLayout;
-
-		if(vkAllocateDescriptorSets(device->device(), &allocInfo, &cameraDescriptorSet) != VK_SUCCESS) {
-			throw std::runtime_error("failed to allocate camera descriptor set!");
-		}
-
-		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = cameraUbo;
-		bufferInfo.offset = 0;
-		bufferInfo.range = sizeof(CameraUbo);
-
-		VkWriteDescriptorSet descriptorWriteUBO{};
-		descriptorWriteUBO.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		descriptorWriteUBO.dstSet          = cameraDescriptorSet;
-		descriptorWriteUBO.dstBinding      = 0;
-		descriptorWriteUBO.dstArrayElement = 0;
-		descriptorWriteUBO.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		descriptorWriteUBO.descriptorCount = 1;
-		descriptorWriteUBO.pBufferInfo     = &bufferInfo;
-
-		vkUpdateDescriptorSets(device->device(), 1, &descriptorWriteUBO, 0, nullptr);
-	}
-
-	void Game::CreateDescriptorSetLayout() {
-		VkDescriptorSetLayoutBinding uboLayoutBinding{};
-		uboLayoutBinding.binding            = 0;
-		uboLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uboLayoutBinding.descriptorCount    = 1;
-		uboLayoutBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
-		uboLayoutBinding.pImmutableSamplers = nullptr;
-
-		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-		samplerLayoutBinding.binding            = 1;
-		samplerLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		samplerLayoutBinding.descriptorCount    = 1;
-		samplerLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
-
-		std::array<VkDescriptorSetLayoutBinding, 2> bindings = {
-			uboLayoutBinding, samplerLayoutBinding
-		};
-		VkDescriptorSetLayoutCreateInfo layoutInfo{};
-		layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-		layoutInfo.pBindings    = bindings.data();
-
-		if(vkCreateDescriptorSetLayout(device->device(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create descriptor set layout!");
-		}
-	}
-
-	void Game::CreateDescriptorPool() {
-		const size_t numFonts = 2; // TODO: Need to find better way to get this count.
-		const size_t numSets = 1 + numFonts;
-
-		std::array<VkDescriptorPoolSize, 2> poolSizes{};
-		poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(numSets);
-		poolSizes[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(numSets);
-
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-		poolInfo.pPoolSizes    = poolSizes.data();
-		poolInfo.maxSets       = static_cast<uint32_t>(numSets);
-
-		if(vkCreateDescriptorPool(device->device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create descriptor pool");
-		}
+	void Game::CreateDescriptors() {
+		// Camera at the fixed uniform binding; everything else registers
+		// itself and passes the index it gets along with its draws.
+		bindless = new Vk::BindlessDescriptors(*device);
+		bindless->SetUniformBuffer(cameraUbo, sizeof(CameraUbo));
 	}
 }
@@ -2,6 +2,8 @@
 
 #include "VkWindow.hpp"
 #include "VkPipeline.hpp"
+#include "VkBindless.hpp"
+#include "PipelineRegistry.hpp"
 #include "VkSwapChain.hpp"
 #include "Block.hpp"
 #include "PlayerPaddle.hpp"
@@ -11,24 +13,85 @@
 #include "GameContext.hpp"
 #include "Loot.hpp"
 #include "Bullet.hpp"
+#include "TripleBuffer.hpp"
+#include "Profiler.hpp"
+#include "GpuScene.hpp"
 
 #include <vector>
 #include <array>
+#include <atomic>
+#include <exception>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace Paddle {
 	struct PendingDestroyEntity {
 		GameEntity* entity = nullptr;
-		uint64_t frameNumber;
+		uint64_t frameNumber; // Simulation tick the entity was dropped from the scene
 	};
 
 	static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
+	// Each category is recorded into its own secondary command buffer by a
+	// job, then stitched together by the primary buffer in this order.
+	enum DrawCategory {
+		DRAW_CATEGORY_BLOCKS = 0,
+		DRAW_CATEGORY_BALL,
+		DRAW_CATEGORY_LOOTS,
+		DRAW_CATEGORY_BULLETS,
+		DRAW_CATEGORY_TEXT,
+		DRAW_CATEGORY_COUNT
+	};
+
+	struct SecondaryCommandBuffer {
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		bool valid = false;
+
+		// What the buffer was last recorded with. If nothing differs this
+		// frame the buffer is executed again as-is.
+		std::vector<DrawCommand> recordedCommands;
+		uint64_t recordedResourceEpoch = 0;
+		uint64_t recordedFontVersion = 0;
+	};
+
+	// Everything the render thread needs from one simulation tick. Built by
+	// the simulation, handed over through a triple buffer and never touched
+	// by the simulation again until it is recycled.
+	struct RenderSnapshot {
+		uint64_t frameNumber = 0;
+		uint64_t resourceEpoch = 0;
+		glm::vec3 cameraPosition;
+		glm::vec3 cameraTarget;
+		std::array<std::vector<DrawCommand>, DRAW_CATEGORY_COUNT> drawCommands;
+		std::vector<GpuInstance> blockInstances; // Instead of block draw commands when GPU-driven
+		DrawView view;
+		TextSnapshot text;
+	};
+
+	// Baked into the mesh pipeline as specialization constants (see
+	// shader.vert). Each combination is its own pipeline variant, so the
+	// driver compiles just the path in use instead of branching per vertex.
+	struct MeshShading {
+		glm::vec3 directionToLight = glm::vec3(2.0f, -2.0f, 5.0f); // Normalized by the shader
+		float ambient = 0.25f;
+		bool lighting = true; // Off: flat tint, no diffuse term
+	};
+
+	// Startup switches, filled in from the command line by main().
+	struct GameOptions {
+		AudioConfig audio;
+		VertexFormat vertexFormat = VERTEX_FORMAT_PACKED;
+		MeshShading shading;
+		bool gpuDriven = true; // Cull and draw blocks on the GPU when the device can
+		std::string tracePath; // Everything the profiler still holds is written here on exit
+		double traceWindowSeconds = PROFILER_DEFAULT_WINDOW_SECONDS; // What F9 writes
+		bool preferLooseAssets = false; // Files on disk override the pack and embedded shaders
+	};
 
 	class Game {
 	public:
-		Game();
+		Game(const GameOptions& options);
 		~Game();
 
 		Game(const Game&) = delete;
@@ -41,29 +104,38 @@ namespace Paddle {
 		void CreateGameEntities();
 		void CreatePipelineLayout();
 		void CreatePipeline();
+		void CreateCommandPools();
 		void CreateCommandBuffers();
+		void FreeCommandBuffers();
 		void CreateVertexBuffer();
 		void CreateIndexBuffer();
 		void CreateUniformBuffer();
-		void CreateDescriptorSetLayout();
-		void CreateDescriptorPool();
-		void CreateDescriptorSet();
+		void CreateDescriptors();
 
 		// === Update / Logic ===
-		void UpdateUniformBuffer(uint32_t currentImage);
+		void UpdateUniformBuffer(const RenderSnapshot& snapshot);
 		void UpdateAllEntitiesPosition(const glm::vec3& delta);
-		void ResetGame(uint64_t currentFrame);
-		void ResetEntities(uint64_t currentFrame);
+		void ResetGame(uint64_t frameNumber);
+		void ResetEntities(uint64_t frameNumber);
 
 		template <typename T>
-		void UpdateDestructionQueue(std::vector<T*>& entities, uint64_t currentFrame, bool deleteAll);
+		void UpdateDestructionQueue(std::vector<T*>& entities, uint64_t frameNumber, bool deleteAll);
 		template <typename T>
-		void UpdateDestructionQueue(std::vector<T*>& entities, uint64_t currentFrame) {
-			UpdateDestructionQueue(entities, currentFrame, false);
+		void UpdateDestructionQueue(std::vector<T*>& entities, uint64_t frameNumber) {
+			UpdateDestructionQueue(entities, frameNumber, false);
 		}
 
-		// === Rendering ===
-		void DrawFrame();
+		// === Simulation -> render hand-off ===
+		void PublishSnapshot(uint64_t frameNumber);
+		void RequestSwapChainRecreate();
+
+		// === Rendering (render thread) ===
+		void RenderLoop();
+		void RecreateSwapChainResources();
+		void DrawFrame(const RenderSnapshot& snapshot);
+		void RecordCommandBuffer(uint32_t imageIndex, const RenderSnapshot& snapshot);
+		void RecordSecondaryCommandBuffer(uint32_t imageIndex, DrawCategory category, const RenderSnapshot& snapshot);
+		VkCommandBufferInheritanceInfo GetInheritanceInfo(uint32_t imageIndex);
 		void RenderScoreFont(std::string scoreText, std::string livesText);
 		void RenderGameOverFont(std::string scoreText);
 
@@ -71,16 +143,44 @@ namespace Paddle {
 		Vk::Window window;
 		Vk::Device* device;
 		Vk::SwapChain* swapChain;
-		Vk::Pipeline* pipeline;
+		PipelineRegistry* pipelines;
+		Vk::Pipeline* pipeline = nullptr; // Owned by pipelines
+		Vk::Pipeline* indirectPipeline = nullptr; // Owned by pipelines, GPU-driven variant
+		MeshShading shading;
+		std::string tracePath;
+		double traceWindowSeconds;
+		JobCounter traceExports; // F9 traces still being written on the job system
 		VkPipelineLayout pipelineLayout;
 		std::vector<VkCommandBuffer> commandBuffers;
 		std::vector<PendingDestroyEntity> destructionQueue;
 
+		// One pool per category: only the job recording that category ever
+		// touches it, which keeps pool access single-threaded.
+		std::array<VkCommandPool, DRAW_CATEGORY_COUNT> recordPools;
+		std::vector<std::array<SecondaryCommandBuffer, DRAW_CATEGORY_COUNT>> secondaryCommandBuffers;
+		uint64_t resourceEpoch = 0;
+
+		// === Render thread ===
+		std::thread renderThread;
+		std::atomic<bool> renderThreadRunning{ false };
+		std::atomic<bool> renderThreadFailed{ false };
+		std::exception_ptr renderThreadError;
+		std::atomic<bool> recreateRequested{ false };
+		TripleBuffer<RenderSnapshot> snapshots;
+
+		// Newest snapshot whose GPU work is known to be finished. Entities
+		// dropped at or before this tick can't be referenced anymore.
+		std::atomic<uint64_t> gpuRetiredFrame{ 0 };
+		std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> inFlightSnapshotFrames{};
+		uint64_t lastSubmittedFrame = 0;
+
+		CameraUbo uploadedCameraUbo{};
+		bool hasUploadedCamera = false;
+
 		VkBuffer cameraUbo;
 		VkDeviceMemory cameraUboMemory;
-		VkDescriptorSetLayout descriptorSetLayout;
-		VkDescriptorPool descriptorPool;
-		VkDescriptorSet cameraDescriptorSet;
+		Vk::BindlessDescriptors* bindless;
+		GpuScene* gpuScene = nullptr; // Null when blocks are drawn from the CPU
 
 		// === Game Components ===
 		GameContext* context;
@@ -1,5 +1,7 @@
 #include "GameCamera.hpp"
 
+#include <glm/gtc/matrix_transform.hpp>
+
 namespace Paddle {
 	const auto DEFAULT_POSITION = glm::vec3(6.0f, 0.0f, 0.0f);
 	const auto DEFAULT_TARGET = glm::vec3(0.0f, 0.0f, 0.0f);
@@ -26,4 +28,40 @@ namespace Paddle {
 		position += right * amount;
 		target += right * amount;
 	}
+
+	CameraUbo GameCamera::MakeUbo(const glm::vec3& position, const glm::vec3& target, float aspect) {
+		CameraUbo ubo{};
+		ubo.view = glm::lookAt(position, target, glm::vec3(0.0f, 0.0f, 1.0f));
+		ubo.proj = glm::perspective(glm::radians(CAMERA_FOV_Y), aspect, CAMERA_NEAR, CAMERA_FAR);
+		ubo.proj[1][1] *= -1;
+		return ubo;
+	}
+
+	//
+	// Frustum
+	//
+
+	Frustum Frustum::FromViewProjection(const glm::mat4& m) {
+		// Gribb & Hartmann: each plane is the last row plus or minus another
+		// row of the matrix (glm is column major, so row i is m[*][i]).
+		auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+		Frustum frustum;
+		frustum.planes[0] = row(3) + row(0); // Left
+		frustum.planes[1] = row(3) - row(0); // Right
+		frustum.planes[2] = row(3) + row(1); // Bottom
+		frustum.planes[3] = row(3) - row(1); // Top
+		frustum.planes[4] = row(3) + row(2); // Near
+		frustum.planes[5] = row(3) - row(2); // Far
+
+		for(auto& plane : frustum.planes) plane /= glm::length(glm::vec3(plane));
+		return frustum;
+	}
+
+	bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+		for(const auto& plane : planes) {
+			if(glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+		}
+		return true;
+	}
 }
@@ -2,11 +2,24 @@
 #include <glm/glm.hpp>
 
 namespace Paddle {
+	// Projection shared by the renderer and anything sizing things on screen.
+	static constexpr float CAMERA_FOV_Y = 45.0f; // Degrees
+	static constexpr float CAMERA_NEAR  = 0.1f;
+	static constexpr float CAMERA_FAR   = 10.0f;
+
 	struct CameraUbo {
 		glm::mat4 view;
 		glm::mat4 proj;
 	};
 
+	// The six clip planes of a view projection, normals pointing inwards.
+	struct Frustum {
+		glm::vec4 planes[6];
+
+		static Frustum FromViewProjection(const glm::mat4& viewProjection);
+		bool IntersectsSphere(const glm::vec3& center, float radius) const;
+	};
+
 	class GameCamera {
 	public:
 		GameCamera();
@@ -17,6 +30,8 @@ namespace Paddle {
 		void SetPosition(const glm::vec3& pos) { position = pos; }
 		glm::vec3 GetPosition() const { return position; }
 		glm::vec3 GetTarget() const { return target; }
+
+		static CameraUbo MakeUbo(const glm::vec3& position, const glm::vec3& target, float aspect);
 	private:
 		glm::vec3 position;
 		glm::vec3 target;
@@ -6,11 +6,20 @@
 #include "GameFont.hpp"
 #include "GameCamera.hpp"
 #include "FlashText.hpp"
+#include "JobSystem.hpp"
+#include "AssetLoader.hpp"
+#include "VertexFormat.hpp"
 
 struct GameContext {
 	// === Vulkan ===
 	Vk::Device* device;
 
+	// === Engine ===
+	Paddle::AssetFileSystem* files;
+	Paddle::JobSystem* jobs;
+	Paddle::AssetLoader* assets;
+	Paddle::VertexFormat vertexFormat = Paddle::VERTEX_FORMAT_PACKED; // Layout of every mesh vertex buffer
+
 	// === Game components ===
 	Paddle::GameSounds* gameSounds;
 	Paddle::GameFont* font;
@@ -25,11 +34,17 @@ struct GameContext {
         time_t bulletResetTime = 0;
 
 	GameContext(Vk::Device* device,
+		        Paddle::AssetFileSystem* files,
+		        Paddle::JobSystem* jobs,
+		        Paddle::AssetLoader* assets,
 		        Paddle::GameSounds* gameSounds,
 		        Paddle::GameFont* font,
 		        Paddle::GameCamera* camera,
                         Paddle::FlashText* fm)
 		: device(device),
+		  files(files),
+		  jobs(jobs),
+		  assets(assets),
 		  gameSounds(gameSounds),
 		  font(font),
 		  camera(camera),
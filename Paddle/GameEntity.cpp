@@ -1,13 +1,14 @@
 #include "GameEntity.hpp"
 #include "Utils.hpp"
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "Vendor\tiny_obj_loader.h"
+#include "VertexFormat.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
+#include <algorithm>
+#include <cfloat>
+
 using Utils::DebugLog;
 
 namespace Paddle {
@@ -26,85 +27,59 @@ namespace Paddle {
 	}
 
 	void GameEntity::LoadModel(std::string path) {
-		DebugLog("Loading model from: " + path);
-
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials; // Not used for now
-		std::string warn, err;
-
-		bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), nullptr, true);
-		if(!warn.empty()) DebugLog("Tinyobj warning: " + warn);
-		if(!err.empty())  DebugLog("Tinyobj error: " + err);
-
-		if(!ret) throw std::runtime_error("Failed to load OBJ file: " + path);
-
-		std::unordered_map<Vertex, uint32_t, VertexHasher> uniqueVertices{};
-		verticesInstance.clear();
-		indicesInstance.clear();
-
-		for(const auto& shape : shapes) {
-			for(const auto& index : shape.mesh.indices) {
-				Vertex vertex{};
-				vertex.color = tintColor;
-
-				// Position
-				if(index.vertex_index >= 0) {
-					vertex.pos = {
-							attrib.vertices[3 * index.vertex_index + 0],
-							attrib.vertices[3 * index.vertex_index + 1],
-							attrib.vertices[3 * index.vertex_index + 2]
-					};
-					vertex.pos *= scale;
-				}
-
-				// Normal
-				if(index.normal_index >= 0) {
-					vertex.normal = {
-							attrib.normals[3 * index.normal_index + 0],
-							attrib.normals[3 * index.normal_index + 1],
-							attrib.normals[3 * index.normal_index + 2]
-					};
-				}
-				else vertex.normal = glm::vec3(0.0f);
-
-				// Texture Coordinates (UV)
-				if(index.texcoord_index >= 0) {
-					vertex.uv = {
-							attrib.texcoords[2 * index.texcoord_index + 0],
-							1.0f - attrib.texcoords[2 * index.texcoord_index + 1] // Flip V
-					};
-				}
-				else vertex.uv = glm::vec2(0.0f);
-
-				// De-duplicate
-				if(uniqueVertices.count(vertex) == 0) {
-					uniqueVertices[vertex] = static_cast<uint32_t>(verticesInstance.size());
-					verticesInstance.push_back(vertex);
-				}
-
-				indicesInstance.push_back(uniqueVertices[vertex]);
-			}
-		}
+		// Mapped once and cached by the loader, every block shares the same file.
+		mesh = &context.assets->GetMesh(path);
+		lods = mesh->lods;
+
+		// The vertices go to the GPU untouched, so scale and rotation are
+		// applied by the model matrix rather than baked in here.
+		meshTransform = glm::yawPitchRoll(rotation.y, rotation.x, rotation.z) * glm::scale(glm::mat4(1.0f), scale);
+		boundingRadius = mesh->boundingRadius * std::max(std::max(scale.x, scale.y), scale.z);
+
+		// Baked for another pipeline layout (e.g. --float-vertices), repack.
+		if(mesh->vertexFormat != context.vertexFormat)
+			verticesInstance = UnpackVertices(mesh->vertexFormat, mesh->vertexData, mesh->vertexCount);
+	}
 
-		// Rotation
-		glm::mat4 rotMatrix = glm::yawPitchRoll(rotation.y, rotation.x, rotation.z);
-		for(auto& v : verticesInstance) {
-			glm::vec4 transformedPos = rotMatrix * glm::vec4(v.pos, 1.0f);
-			glm::vec4 transformedNormal = rotMatrix * glm::vec4(v.normal, 0.0f);
+	const MeshLod& GameEntity::SelectLod(const DrawView& view, const glm::vec3& center, float radius) const {
+		const float distance = std::max(glm::length(center - view.cameraPosition), CAMERA_NEAR);
+		const float pixelSize = 2.0f * radius / distance * view.pixelsPerUnit;
 
-			v.pos = glm::vec3(transformedPos);
-			v.normal = glm::normalize(glm::vec3(transformedNormal));
+		// Coarsest level that is still allowed at this size.
+		size_t selected = 0;
+		for(size_t level = 1; level < lods.size(); ++level) {
+			if(pixelSize <= lods[level].maxPixelSize) selected = level;
 		}
+		return lods[selected];
 	}
 
 	void GameEntity::InitialiseEntity() {
+		if(!mesh) {
+			if(lods.empty()) lods.assign(1, MeshLod{ 0, static_cast<uint32_t>(indicesInstance.size()), FLT_MAX });
+
+			boundingRadius = 0.0f;
+			for(const auto& v : verticesInstance) boundingRadius = std::max(boundingRadius, glm::length(v.pos));
+		}
+
 		CreateVertexBuffer();
 		CreateIndexBuffer();
 	}
 
 	void GameEntity::CreateVertexBuffer() {
-		VkDeviceSize bufferSize = sizeof(verticesInstance[0]) * verticesInstance.size();
+		// Loaded models upload straight out of the mapped file.
+		std::vector<uint8_t> packed;
+		const void* source;
+		VkDeviceSize bufferSize;
+		if(mesh && verticesInstance.empty()) {
+			source = mesh->vertexData;
+			bufferSize = static_cast<VkDeviceSize>(mesh->vertexCount) * GetVertexStride(mesh->vertexFormat);
+		}
+		else {
+			packed = PackVertices(context.vertexFormat, verticesInstance);
+			source = packed.data();
+			bufferSize = packed.size();
+		}
+
 		context.device->createBuffer(
 			bufferSize,
 			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
@@ -114,12 +89,15 @@ namespace Paddle {
 		context.device->SetObjectName((uint64_t)vertexBuffer, VK_OBJECT_TYPE_BUFFER, "Block Vertex Buffer");
 		void* data;
 		vkMapMemory(context.device->device(), vertexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, verticesInstance.data(), (size_t)bufferSize);
+		memcpy(data, source, (size_t)bufferSize);
 		vkUnmapMemory(context.device->device(), vertexBufferMemory);
 	}
 
 	void GameEntity::CreateIndexBuffer() {
-		VkDeviceSize bufferSize = sizeof(indicesInstance[0]) * indicesInstance.size();
+		const uint32_t* source = mesh ? mesh->indexData : indicesInstance.data();
+		const size_t indexCount = mesh ? mesh->indexCount : indicesInstance.size();
+
+		VkDeviceSize bufferSize = sizeof(uint32_t) * indexCount;
 		context.device->createBuffer(
 			bufferSize,
 			VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
@@ -129,38 +107,44 @@ namespace Paddle {
 		context.device->SetObjectName((uint64_t)indexBuffer, VK_OBJECT_TYPE_BUFFER, "Block Index Buffer");
 		void* data;
 		vkMapMemory(context.device->device(), indexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indicesInstance.data(), (size_t)bufferSize);
+		memcpy(data, source, (size_t)bufferSize);
 		vkUnmapMemory(context.device->device(), indexBufferMemory);
 	}
 
-	void GameEntity::UpdateVertexColors(const glm::vec4& color) {
-		// Update color in all vertices
-		for(auto& v : verticesInstance) {
-			v.color = color;
-		}
-		// Re-upload to GPU
-		VkDeviceSize bufferSize = sizeof(verticesInstance[0]) * verticesInstance.size();
-		void* data;
-		vkMapMemory(context.device->device(), vertexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, verticesInstance.data(), (size_t)bufferSize);
-		vkUnmapMemory(context.device->device(), vertexBufferMemory);
-	}
+	void GameEntity::CollectDrawCommands(const DrawView& view, std::vector<DrawCommand>& commands) {
+		if(!view.frustum.IntersectsSphere(position, boundingRadius)) return;
 
-	void GameEntity::Draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet) {
 		glm::mat4 model = glm::mat4(1.0f);
 		model = glm::translate(model, position);
 		model = glm::rotate(model, rotation.x, glm::vec3(1, 0, 0));
 		model = glm::rotate(model, rotation.y, glm::vec3(0, 1, 0));
 		model = glm::rotate(model, rotation.z, glm::vec3(0, 0, 1));
+		model = model * meshTransform;
 
-		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
+		const MeshLod& lod = SelectLod(view, position, boundingRadius);
+		commands.push_back(DrawCommand{ model, tintColor, vertexBuffer, indexBuffer, lod.firstIndex, lod.indexCount });
+	}
 
-		VkBuffer vertexBuffers[] = { vertexBuffer };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	void GameEntity::RecordDrawCommands(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const std::vector<DrawCommand>& commands) {
+		VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+		VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
 
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
-		vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indicesInstance.size()), 1, 0, 0, 0);
+		for(const auto& command : commands) {
+			const MeshPushConstants pushConstants{ command.model, command.tint, 0 };
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &pushConstants);
+
+			// Debris pieces share their block's buffers, skip redundant binds.
+			if(command.vertexBuffer != boundVertexBuffer) {
+				VkDeviceSize offsets[] = { 0 };
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, &command.vertexBuffer, offsets);
+				boundVertexBuffer = command.vertexBuffer;
+			}
+			if(command.indexBuffer != boundIndexBuffer) {
+				vkCmdBindIndexBuffer(commandBuffer, command.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+				boundIndexBuffer = command.indexBuffer;
+			}
+
+			vkCmdDrawIndexed(commandBuffer, command.indexCount, 1, command.firstIndex, 0, 0);
+		}
 	}
 }
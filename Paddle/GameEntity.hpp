@@ -2,6 +2,7 @@
 
 #include "GameVertex.hpp"
 #include "GameContext.hpp"
+#include "MeshFile.hpp"
 
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
@@ -9,6 +10,50 @@
 #include <vector>
 
 namespace Paddle {
+	// Per-draw data of the main pipeline, matches shader.vert. GPU-driven
+	// draws only set the instance buffer, everything else comes from it.
+	struct MeshPushConstants {
+		glm::mat4 model;
+		glm::vec4 tint;
+		uint32_t instanceBufferIndex; // Bindless storage buffer slot
+	};
+
+	// One instance drawn by the GPU-driven path, matches Instance in
+	// shader.vert and cull.comp (std430).
+	struct GpuInstance {
+		glm::mat4 model;
+		glm::vec4 tint;
+		glm::vec4 boundingSphere; // World space center and radius
+	};
+	static_assert(sizeof(GpuInstance) == 96, "GpuInstance layout is shared with the shaders");
+
+	// Everything needed to replay one indexed draw of an entity. Kept as plain
+	// data so the recorder can compare this frame's list against the one a
+	// cached secondary command buffer was recorded with.
+	struct DrawCommand {
+		glm::mat4 model;
+		glm::vec4 tint;
+		VkBuffer vertexBuffer;
+		VkBuffer indexBuffer;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+
+		bool operator==(const DrawCommand& other) const {
+			return vertexBuffer == other.vertexBuffer && indexBuffer == other.indexBuffer &&
+				firstIndex == other.firstIndex && indexCount == other.indexCount &&
+				model == other.model && tint == other.tint;
+		}
+		bool operator!=(const DrawCommand& other) const { return !(*this == other); }
+	};
+
+	// Camera state CollectDrawCommands() needs to cull entities and size
+	// them on screen.
+	struct DrawView {
+		glm::vec3 cameraPosition;
+		float pixelsPerUnit; // Pixels covered by one unit at distance one
+		Frustum frustum;
+	};
+
 	class GameEntity {
 	public:
 		GameEntity(GameContext &context);
@@ -29,7 +74,9 @@ namespace Paddle {
 		void SetTintColor(const glm::vec4& color) { tintColor = color; }
 
 		virtual void Update() {}
-		virtual void Draw(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+		virtual void CollectDrawCommands(const DrawView& view, std::vector<DrawCommand>& commands);
+
+		static void RecordDrawCommands(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const std::vector<DrawCommand>& commands);
 
 		virtual bool CheckCollision(GameEntity* other) { return false; }
 
@@ -47,7 +94,14 @@ namespace Paddle {
 
 		void InitialiseEntity();
 		void LoadModel(std::string path);
-		void UpdateVertexColors(const glm::vec4& color);
+
+		const MeshLod& SelectLod(const DrawView& view, const glm::vec3& center, float radius) const;
+
+		std::vector<MeshLod> lods; // Finest first, a single level unless filled before InitialiseEntity()
+		float boundingRadius = 0.0f; // Around the model origin
+
+		const MeshData* mesh = nullptr; // Set by LoadModel(), owned by the asset loader
+		glm::mat4 meshTransform = glm::mat4(1.0f); // Scale and rotation LoadModel() leaves to the model matrix
 
 		glm::vec3 scale = glm::vec3(1.0f);
 		glm::vec4 tintColor = glm::vec4(1.0f);
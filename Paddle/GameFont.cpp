@@ -3,321 +3,364 @@
 #include "VkDevice.hpp"
 #include "VkPipeline.hpp"
 #include "Utils.hpp"
+#include "Profiler.hpp"
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "Vendor\stb_truetype.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/norm.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <cstring>
 #include <stdexcept>
 #include <type_traits>
 #include <functional>
 #include <array>
+#include <algorithm>
 
-using Utils::DestroyPtr;
 using Utils::DebugLog;
 
 namespace Paddle {
-	GameFont::GameFont(Vk::Device& device, VkDescriptorPool& descriptorPool, Vk::SwapChain& swapChain)
-		: device(device), descriptorPool(descriptorPool), swapChain(swapChain) {
-		texWidth = 512;
-		texHeight = 512;
+	// AddText() positions and scales are in units of a 96px font, what the
+	// old coverage bake used. The SDF is rendered much smaller and scaled up
+	// by the shader without going soft.
+	static constexpr float FONT_LAYOUT_PIXEL_HEIGHT = 96.0f;
+	static constexpr float FONT_SDF_PIXEL_HEIGHT = 32.0f;
 
-		fontFilePath[FontFamily::FONT_FAMILY_TITLE] = "Assets\\Font\\HennyPenny-Regular.ttf";
-		fontFilePath[FontFamily::FONT_FAMILY_BODY] = "Assets\\Font\\ZillaSlab-Regular.ttf";
+	static const char* TITLE_FONT_PATH = "Assets/Font/HennyPenny-Regular.ttf";
+	static const char* BODY_FONT_PATH  = "Assets/Font/ZillaSlab-Regular.ttf";
+
+	static const char* FONT_VERT_SHADER_PATH = "Shader/font.vert.spv";
+	static const char* FONT_FRAG_SHADER_PATH = "Shader/font.frag.spv";
+
+	// Matches PushConstants in font.vert / font.frag.
+	struct FontPushConstants {
+		glm::mat4 proj;
+		uint32_t textureIndex;
+	};
+
+	GameFont::GameFont(Vk::Device& device, Vk::BindlessDescriptors& bindless, Vk::SwapChain& swapChain, AssetLoader& assets, PipelineRegistry& pipelines)
+		: device(device), bindless(bindless), swapChain(swapChain), assets(assets), pipelines(pipelines) {
+		fontFilePath[FontFamily::FONT_FAMILY_TITLE] = TITLE_FONT_PATH;
+		fontFilePath[FontFamily::FONT_FAMILY_BODY] = BODY_FONT_PATH;
 
 		CreateFonts();
 		CreateFontBuffers();
-		CreateDescriptorSet();
+		CreateIndexBuffer();
+		RegisterTexture();
 		CreatePipelineLayout();
 	}
 
 	GameFont::~GameFont() {
 		DebugLog("Destroying GameFont resources.");
 
-		for (auto it = fontFilePath.begin(); it != fontFilePath.end(); ++it) {
-			FontFamilyData font = fontsTable[(*it).first];
-			if (font.vertexBuffer != VK_NULL_HANDLE)
-				vkDestroyBuffer(device.device(), font.vertexBuffer, nullptr);
-			else DebugLog("Font vertex buffer is null, skipping destruction.");
+		if (stagingBuffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(device.device(), stagingBuffer, nullptr);
+		else DebugLog("Font staging buffer is null, skipping destruction.");
 
-			if (font.vertexBufferMemory != VK_NULL_HANDLE)
-				vkFreeMemory(device.device(), font.vertexBufferMemory, nullptr);
-			else DebugLog("Font vertex buffer memory is null, skipping destruction.");
+		if (stagingBufferMemory != VK_NULL_HANDLE)
+			vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
+		else DebugLog("Font staging buffer memory is null, skipping destruction.");
 
-			if (font.stagingBuffer != VK_NULL_HANDLE)
-				vkDestroyBuffer(device.device(), font.stagingBuffer, nullptr);
-			else DebugLog("Font staging buffer is null, skipping destruction.");
+		if (fontImageView != VK_NULL_HANDLE)
+			vkDestroyImageView(device.device(), fontImageView, nullptr);
+		else DebugLog("Font image view is null, skipping destruction.");
 
-			if (font.stagingBufferMemory != VK_NULL_HANDLE)
-				vkFreeMemory(device.device(), font.stagingBufferMemory, nullptr);
-			else DebugLog("Font staging buffer memory is null, skipping destruction.");
+		if (fontImage != VK_NULL_HANDLE)
+			vkDestroyImage(device.device(), fontImage, nullptr);
+		else DebugLog("Font image is null, skipping destruction.");
 
-			if (font.fontImageView != VK_NULL_HANDLE)
-				vkDestroyImageView(device.device(), font.fontImageView, nullptr);
-			else DebugLog("Font image view is null, skipping destruction.");
+		if (fontImageMemory != VK_NULL_HANDLE)
+			vkFreeMemory(device.device(), fontImageMemory, nullptr);
+		else DebugLog("Font image memory is null, skipping destruction.");
 
-			if (font.fontImage != VK_NULL_HANDLE)
-				vkDestroyImage(device.device(), font.fontImage, nullptr);
-			else DebugLog("Font image is null, skipping destruction.");
+		if (fontSampler != VK_NULL_HANDLE)
+			vkDestroySampler(device.device(), fontSampler, nullptr);
+		else DebugLog("Font sampler is null, skipping destruction.");
 
-			if (font.fontImageMemory != VK_NULL_HANDLE)
-				vkFreeMemory(device.device(), font.fontImageMemory, nullptr);
-			else DebugLog("Font image memory is null, skipping destruction.");
+		for (auto& frameBuffer : frameBuffers) DestroyFrameBuffer(frameBuffer);
 
-			if (font.fontSampler != VK_NULL_HANDLE)
-				vkDestroySampler(device.device(), font.fontSampler, nullptr);
-			else DebugLog("Font sampler is null, skipping destruction.");
+		if (indexBuffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(device.device(), indexBuffer, nullptr);
+		if (indexBufferMemory != VK_NULL_HANDLE)
+			vkFreeMemory(device.device(), indexBufferMemory, nullptr);
 
-			delete[] font.bitmap;
-		}
 		if (fontPipelineLayout != VK_NULL_HANDLE)
 			vkDestroyPipelineLayout(device.device(), fontPipelineLayout, nullptr);
-		if (descriptorSetLayout != VK_NULL_HANDLE)
-			vkDestroyDescriptorSetLayout(device.device(), descriptorSetLayout, nullptr);
-		DestroyPtr(fontPipeline);
+	}
+
+	void GameFont::Prefetch(AssetLoader& assets) {
+		assets.PrefetchFont(TITLE_FONT_PATH, FONT_SDF_PIXEL_HEIGHT);
+		assets.PrefetchFont(BODY_FONT_PATH, FONT_SDF_PIXEL_HEIGHT);
+		assets.PrefetchFile(FONT_VERT_SHADER_PATH);
+		assets.PrefetchFile(FONT_FRAG_SHADER_PATH);
 	}
 
 	void GameFont::CreateFonts() {
+		//
+		// Stack every family's atlas into one page so all text shares a
+		// single image and descriptor set
+		//
+		atlasWidth = 0;
+		atlasHeight = 0;
+		std::array<const FontBitmap*, FONT_FAMILY_COUNT> bitmaps{};
 		for (auto it = fontFilePath.begin(); it != fontFilePath.end(); ++it) {
-			unsigned char* fontBuffer = new unsigned char[1 << 20];
-			fontsTable[(*it).first].bitmap = new unsigned char[texWidth * texHeight];
-
-			FILE* fontFile = nullptr;
-			if (fopen_s(&fontFile, (*it).second.c_str(), "rb") != 0 || !fontFile) {
-				throw std::runtime_error("Failed to open font file " + (*it).second);
-			}
+			const FontBitmap& baked = assets.GetFont((*it).second, FONT_SDF_PIXEL_HEIGHT);
+			bitmaps[static_cast<size_t>((*it).first)] = &baked;
 
-			fread(fontBuffer, 1, 1 << 20, fontFile);
-			fclose(fontFile);
+			auto& font = fontsTable[(*it).first];
+			font.filePath = (*it).second;
+			font.atlasOffsetY = atlasHeight;
+			font.layoutScale = FONT_LAYOUT_PIXEL_HEIGHT / baked.pixelHeight;
+			font.fontAscent = baked.ascent;
+			memcpy(font.bakedChars, baked.bakedChars, sizeof(font.bakedChars));
+
+			atlasWidth = std::max(atlasWidth, baked.width);
+			atlasHeight += baked.height;
+		}
 
-			if (!stbtt_InitFont(&fontsTable[(*it).first].fontInfo, fontBuffer, stbtt_GetFontOffsetForIndex(fontBuffer, 0))) {
-				throw std::runtime_error("Failed to init font info!");
+		atlasPixels.assign(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+		for (auto it = fontsTable.begin(); it != fontsTable.end(); ++it) {
+			const FontBitmap& baked = *bitmaps[static_cast<size_t>((*it).first)];
+			for (int row = 0; row < baked.height; ++row) {
+				memcpy(&atlasPixels[static_cast<size_t>((*it).second.atlasOffsetY + row) * atlasWidth],
+					&baked.pixels[static_cast<size_t>(row) * baked.width], baked.width);
 			}
-
-			int ascent, descent, lineGap;
-			stbtt_GetFontVMetrics(&fontsTable[(*it).first].fontInfo, &ascent, &descent, &lineGap);
-			fontsTable[(*it).first].fontAscent = ascent;
-
-			stbtt_BakeFontBitmap(fontBuffer, 0, 96.0, fontsTable[(*it).first].bitmap, texWidth, texHeight, 32, 96, fontsTable[(*it).first].bakedChars);
-			delete[] fontBuffer;
 		}
 	}
 
 	void GameFont::CreateFontBuffers() {
-		VkDeviceSize imageSize = texWidth * texHeight;
+		VkDeviceSize imageSize = atlasPixels.size();
+
+		device.createBuffer(
+			imageSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			stagingBuffer,
+			stagingBufferMemory);
+		device.SetObjectName((uint64_t)stagingBuffer, VK_OBJECT_TYPE_BUFFER, "Font Atlas Staging Buffer");
+
+		void* data;
+		vkMapMemory(device.device(), stagingBufferMemory, 0, imageSize, 0, &data);
+		memcpy(data, atlasPixels.data(), static_cast<size_t>(imageSize));
+		vkUnmapMemory(device.device(), stagingBufferMemory);
+
+		device.createImage(
+			atlasWidth, atlasHeight,
+			VK_FORMAT_R8_UNORM,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			fontImage,
+			fontImageMemory);
+
+		device.transitionImageLayout(fontImage, VK_FORMAT_R8_UNORM,
+			VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		device.copyBufferToImage(stagingBuffer, fontImage, atlasWidth, atlasHeight);
+		device.transitionImageLayout(fontImage, VK_FORMAT_R8_UNORM,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = fontImage;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R8_UNORM;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		if (vkCreateImageView(device.device(), &viewInfo, nullptr, &fontImageView) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create font atlas image view!");
+		}
 
-		for (auto it = fontFilePath.begin(); it != fontFilePath.end(); ++it) {
-			auto& font = fontsTable[(*it).first];
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+
+		if (vkCreateSampler(device.device(), &samplerInfo, nullptr, &fontSampler) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create font sampler!");
+		}
+	}
 
-			device.createBuffer(
-				imageSize,
-				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				font.stagingBuffer,
-				font.stagingBufferMemory);
-			device.SetObjectName((uint64_t)font.stagingBuffer, VK_OBJECT_TYPE_BUFFER, (*it).second + " Font Staging Buffer");
-
-			void* data;
-			vkMapMemory(device.device(), font.stagingBufferMemory, 0, imageSize, 0, &data);
-			memcpy(data, font.bitmap, static_cast<size_t>(imageSize));
-			vkUnmapMemory(device.device(), font.stagingBufferMemory);
-
-			device.createImage(
-				texWidth, texHeight,
-				VK_FORMAT_R8_UNORM,
-				VK_IMAGE_TILING_OPTIMAL,
-				VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-				font.fontImage,
-				font.fontImageMemory);
-
-			device.transitionImageLayout(font.fontImage, VK_FORMAT_R8_UNORM,
-				VK_IMAGE_LAYOUT_UNDEFINED,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-			device.copyBufferToImage(font.stagingBuffer, font.fontImage, texWidth, texHeight);
-			device.transitionImageLayout(font.fontImage, VK_FORMAT_R8_UNORM,
-				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-			VkImageViewCreateInfo viewInfo{};
-			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-			viewInfo.image = font.fontImage;
-			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-			viewInfo.format = VK_FORMAT_R8_UNORM;
-			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			viewInfo.subresourceRange.baseMipLevel = 0;
-			viewInfo.subresourceRange.levelCount = 1;
-			viewInfo.subresourceRange.baseArrayLayer = 0;
-			viewInfo.subresourceRange.layerCount = 1;
-
-			if (vkCreateImageView(device.device(), &viewInfo, nullptr, &font.fontImageView) != VK_SUCCESS) {
-				throw std::runtime_error("failed to create " + (*it).second + " font image view!");
-			}
 
-			VkSamplerCreateInfo samplerInfo{};
-			samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-			samplerInfo.magFilter = VK_FILTER_LINEAR;
-			samplerInfo.minFilter = VK_FILTER_LINEAR;
-			samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-			samplerInfo.anisotropyEnable = VK_FALSE;
-			samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_WHITE;
-			samplerInfo.unnormalizedCoordinates = VK_FALSE;
-			samplerInfo.compareEnable = VK_FALSE;
-			samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-
-			if (vkCreateSampler(device.device(), &samplerInfo, nullptr, &font.fontSampler) != VK_SUCCESS) {
-				throw std::runtime_error("failed to create font sampler!");
-			}
+	void GameFont::CreateIndexBuffer() {
+		std::vector<uint16_t> indices;
+		indices.reserve(MAX_TEXT_GLYPHS * 6);
+		for (uint32_t glyph = 0; glyph < MAX_TEXT_GLYPHS; ++glyph) {
+			const uint16_t base = static_cast<uint16_t>(glyph * 4);
+			indices.push_back(base + 0);
+			indices.push_back(base + 1);
+			indices.push_back(base + 2);
+			indices.push_back(base + 2);
+			indices.push_back(base + 1);
+			indices.push_back(base + 3);
 		}
+
+		const VkDeviceSize bufferSize = sizeof(uint16_t) * indices.size();
+
+		//
+		// Written once, so it lives in device local memory
+		//
+		VkBuffer indexStagingBuffer;
+		VkDeviceMemory indexStagingMemory;
+		device.createBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			indexStagingBuffer,
+			indexStagingMemory);
+
+		void* data;
+		vkMapMemory(device.device(), indexStagingMemory, 0, bufferSize, 0, &data);
+		memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
+		vkUnmapMemory(device.device(), indexStagingMemory);
+
+		device.createBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			indexBuffer,
+			indexBufferMemory);
+		device.SetObjectName((uint64_t)indexBuffer, VK_OBJECT_TYPE_BUFFER, "Font Index Buffer");
+		device.copyBuffer(indexStagingBuffer, indexBuffer, bufferSize);
+
+		vkDestroyBuffer(device.device(), indexStagingBuffer, nullptr);
+		vkFreeMemory(device.device(), indexStagingMemory, nullptr);
 	}
 
+	void GameFont::CopyText(TextSnapshot& snapshot) const {
+		// assign() reuses the snapshot's storage, no per-frame allocation.
+		snapshot.vertices.assign(verticesInstance.begin(), verticesInstance.end());
+	}
 
-	void GameFont::CreateVertexBuffer() {
-		for (auto it = fontFilePath.begin(); it != fontFilePath.end(); ++it) {
-			auto& font = fontsTable[(*it).first];
+	void GameFont::UploadText(uint32_t imageIndex, const TextSnapshot& snapshot) {
+		PROFILE_SCOPE("Text upload");
+		if (imageIndex >= frameBuffers.size()) {
+			frameBuffers.resize(imageIndex + 1);
+			imageVersions.resize(imageIndex + 1, 0);
+		}
 
-			vkDeviceWaitIdle(device.device());
-			if (font.vertexBuffer != VK_NULL_HANDLE) {
-				vkDestroyBuffer(device.device(), font.vertexBuffer, nullptr);
-				font.vertexBuffer = VK_NULL_HANDLE;
-			}
-			if (font.vertexBufferMemory != VK_NULL_HANDLE) {
-				vkFreeMemory(device.device(), font.vertexBufferMemory, nullptr);
-				font.vertexBufferMemory = VK_NULL_HANDLE;
-			}
+		auto& frameBuffer = frameBuffers[imageIndex];
+		const auto& vertices = snapshot.vertices;
+		const VkDeviceSize bufferSize = sizeof(TextVertex) * vertices.size();
+
+		if (static_cast<uint32_t>(vertices.size()) != frameBuffer.vertexCount) {
+			frameBuffer.vertexCount = static_cast<uint32_t>(vertices.size());
+			++imageVersions[imageIndex];
+		}
+		if (bufferSize == 0) return;
 
-			VkDeviceSize bufferSize = sizeof(font.verticesInstance[0]) * font.verticesInstance.size();
-			if (bufferSize == 0) continue;
+		//
+		// Grow geometrically so text that keeps changing settles quickly
+		//
+		if (bufferSize > frameBuffer.capacity) {
+			DestroyFrameBuffer(frameBuffer);
 
+			frameBuffer.capacity = std::max(bufferSize, frameBuffer.capacity * 2);
 			device.createBuffer(
-				bufferSize,
+				frameBuffer.capacity,
 				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
 				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-				font.vertexBuffer,
-				font.vertexBufferMemory);
-			device.SetObjectName((uint64_t)font.vertexBuffer, VK_OBJECT_TYPE_BUFFER, "Font Vertex Buffer");
-			void* data;
-			vkMapMemory(device.device(), font.vertexBufferMemory, 0, bufferSize, 0, &data);
-			memcpy(data, font.verticesInstance.data(), (size_t)bufferSize);
-			vkUnmapMemory(device.device(), font.vertexBufferMemory);
+				frameBuffer.buffer,
+				frameBuffer.memory);
+			device.SetObjectName((uint64_t)frameBuffer.buffer, VK_OBJECT_TYPE_BUFFER, "Font Vertex Buffer");
+			vkMapMemory(device.device(), frameBuffer.memory, 0, frameBuffer.capacity, 0, &frameBuffer.mapped);
+			++imageVersions[imageIndex];
 		}
+
+		memcpy(frameBuffer.mapped, vertices.data(), static_cast<size_t>(bufferSize));
+	}
+
+	void GameFont::DestroyFrameBuffer(FontFrameBuffer& frameBuffer) {
+		if (frameBuffer.buffer == VK_NULL_HANDLE) return;
+
+		vkUnmapMemory(device.device(), frameBuffer.memory);
+		vkDestroyBuffer(device.device(), frameBuffer.buffer, nullptr);
+		vkFreeMemory(device.device(), frameBuffer.memory, nullptr);
+
+		const VkDeviceSize capacity = frameBuffer.capacity;
+		frameBuffer = FontFrameBuffer{};
+		frameBuffer.capacity = capacity;
 	}
 
 
 	void GameFont::AddText(FontFamily family, const std::string& text, float x, float y, float scale, glm::vec3 color) {
+		PROFILE_SCOPE("Text tessellation");
 		auto& font = fontsTable[family];
 
-		float startX = x;
-		float startY = y;
-		float posX = x;
-		float posY = y;
+		// Glyph rects are in atlas pixels, stretch them to layout units. No
+		// pixel snapping like stbtt_GetBakedQuad, the distance field doesn't
+		// need it and it would jitter at large scales.
+		const float glyphScale = scale * font.layoutScale;
+		const float invAtlasWidth = 1.0f / atlasWidth;
+		const float invAtlasHeight = 1.0f / atlasHeight;
+
+		const uint32_t packedColor = glm::packUnorm4x8(glm::vec4(color, 1.0f));
+
+		float penX = 0.0f;
 		for (char c : text) {
 			if (c < 32 || c >= 128)
 				continue;
-			stbtt_aligned_quad q;
-			stbtt_GetBakedQuad(font.bakedChars, texWidth, texHeight, c - 32, &posX, &posY, &q, 1);
-
-			float x0 = startX + (q.x0 - x) * scale;
-			float y0 = startY + (q.y0 - y) * scale;
-			float x1 = startX + (q.x1 - x) * scale;
-			float y1 = startY + (q.y1 - y) * scale;
-			glm::vec3 normal = { 0.0f, 0.0f, 1.0f };
-
-			// First triangle
-			font.verticesInstance.push_back({ {x0, y0, 0.0f}, color, normal, {q.s0, q.t0} });
-			font.verticesInstance.push_back({ {x1, y0, 0.0f}, color, normal, {q.s1, q.t0} });
-			font.verticesInstance.push_back({ {x0, y1, 0.0f}, color, normal, {q.s0, q.t1} });
-
-			// Second triangle
-			font.verticesInstance.push_back({ {x0, y1, 0.0f}, color, normal, {q.s0, q.t1} });
-			font.verticesInstance.push_back({ {x1, y0, 0.0f}, color, normal, {q.s1, q.t0} });
-			font.verticesInstance.push_back({ {x1, y1, 0.0f}, color, normal, {q.s1, q.t1} });
+			if (verticesInstance.size() >= MAX_TEXT_GLYPHS * 4)
+				break;
+			const stbtt_bakedchar& b = font.bakedChars[c - 32];
+			const uint16_t s0 = glm::packUnorm1x16(b.x0 * invAtlasWidth);
+			const uint16_t t0 = glm::packUnorm1x16((font.atlasOffsetY + b.y0) * invAtlasHeight);
+			const uint16_t s1 = glm::packUnorm1x16(b.x1 * invAtlasWidth);
+			const uint16_t t1 = glm::packUnorm1x16((font.atlasOffsetY + b.y1) * invAtlasHeight);
+
+			float x0 = x + (penX + b.xoff) * glyphScale;
+			float y0 = y + b.yoff * glyphScale;
+			float x1 = x0 + (b.x1 - b.x0) * glyphScale;
+			float y1 = y0 + (b.y1 - b.y0) * glyphScale;
+			penX += b.xadvance;
+
+			// Corners in index buffer order: top left, top right, bottom left, bottom right
+			verticesInstance.push_back({ {x0, y0}, {s0, t0}, packedColor });
+			verticesInstance.push_back({ {x1, y0}, {s1, t0}, packedColor });
+			verticesInstance.push_back({ {x0, y1}, {s0, t1}, packedColor });
+			verticesInstance.push_back({ {x1, y1}, {s1, t1}, packedColor });
 		}
 	}
 
 	void GameFont::ClearText() {
-		for (auto it = fontFilePath.begin(); it != fontFilePath.end(); ++it) {
-			auto& font = fontsTable[(*it).first];
-			font.verticesInstance.clear();
-		}
+		verticesInstance.clear();
 	}
 
 	void GameFont::SetText(FontFamily family, const std::string& text, float x, float y, float scale, glm::vec3 color) {
 		ClearText();
 		AddText(family, text, x, y, scale, color);
-		CreateVertexBuffer();
 	}
 
-	void GameFont::CreateDescriptorSet() {
-		//
-		// Descriptor set layout
-		//
-		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-		samplerLayoutBinding.binding = 1;
-		samplerLayoutBinding.descriptorCount = 1;
-		samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
-		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-		VkDescriptorSetLayoutCreateInfo layoutInfo{};
-		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = 1;
-		layoutInfo.pBindings = &samplerLayoutBinding;
-
-		if (vkCreateDescriptorSetLayout(device.device(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create font descriptor set layout!");
-		}
-
-		const auto& fontFamilies = fontsTable;
-		for (const auto& kv : fontFamilies) {
-			FontFamily family = kv.first;
-			VkDescriptorSet fontDescriptorSet;
-
-			VkDescriptorSetAllocateInfo fontAllocInfo{};
-			fontAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			fontAllocInfo.descriptorPool = descriptorPool;
-			fontAllocInfo.descriptorSetCount = 1;
-			fontAllocInfo.pSetLayouts = &descriptorSetLayout;
-
-			if (vkAllocateDescriptorSets(device.device(), &fontAllocInfo, &fontDescriptorSet) != VK_SUCCESS) {
-				throw std::runtime_error("failed to allocate font descriptor set!");
-			}
-
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = fontsTable[family].fontImageView;
-			imageInfo.sampler = fontsTable[family].fontSampler;
-
-			VkWriteDescriptorSet descriptorWriteImage{};
-			descriptorWriteImage.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWriteImage.dstSet = fontDescriptorSet;
-			descriptorWriteImage.dstBinding = 1;
-			descriptorWriteImage.dstArrayElement = 0;
-			descriptorWriteImage.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWriteImage.descriptorCount = 1;
-			descriptorWriteImage.pImageInfo = &imageInfo;
-
-			vkUpdateDescriptorSets(device.device(), 1, &descriptorWriteImage, 0, nullptr);
-
-			fontsTable[family].fontDescriptorSets = fontDescriptorSet;
-		}
+	void GameFont::RegisterTexture() {
+		fontTextureIndex = bindless.AddTexture(fontImageView, fontSampler);
 	}
 
 	void GameFont::CreatePipelineLayout() {
 		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(glm::mat4);
+		pushConstantRange.size = sizeof(FontPushConstants);
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 
+		const VkDescriptorSetLayout setLayout = bindless.GetLayout();
 		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -329,38 +372,33 @@ namespace Paddle {
 	static VkVertexInputBindingDescription getFontBindingDescription() {
 		VkVertexInputBindingDescription bindingDescription{};
 		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
+		bindingDescription.stride = sizeof(TextVertex);
 		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 		return bindingDescription;
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 4> getFontAttributeDescriptions() {
-		std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions{};
+	static std::array<VkVertexInputAttributeDescription, 3> getFontAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
+		attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(TextVertex, pos);
 
 		attributeDescriptions[1].binding = 0;
 		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, color);
+		attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+		attributeDescriptions[1].offset = offsetof(TextVertex, uv);
 
 		attributeDescriptions[2].binding = 0;
 		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(Vertex, normal);
-
-		attributeDescriptions[3].binding = 0;
-		attributeDescriptions[3].location = 3;
-		attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[3].offset = offsetof(Vertex, uv);
+		attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[2].offset = offsetof(TextVertex, color);
 
 		return attributeDescriptions;
 	}
 
 	void GameFont::CreatePipeline() {
-		DestroyPtr<Vk::Pipeline>(fontPipeline);
+		for (auto& imageVersion : imageVersions) ++imageVersion;
 
 		auto pipelineConfig = Vk::Pipeline::DefaultPipelineConfigInfo(swapChain.width(), swapChain.height());
 		pipelineConfig.renderPass = swapChain.getRenderPass();
@@ -377,14 +415,10 @@ namespace Paddle {
 
 		pipelineConfig.vertexInputInfo = vertexInputInfo;
 
-		fontPipeline = new Vk::Pipeline(
-			device,
-			"Shader\\font.vert.spv",
-			"Shader\\font.frag.spv",
-			pipelineConfig);
+		fontPipeline = pipelines.Get(FONT_VERT_SHADER_PATH, FONT_FRAG_SHADER_PATH, pipelineConfig);
 	}
 
-	void GameFont::Draw(VkCommandBuffer commandBuffer) {
+	void GameFont::Draw(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
 		float orthoLeft = -static_cast<float>(swapChain.width()) / 2.0f;
 		float orthoRight = static_cast<float>(swapChain.width()) / 2.0f;
 		float orthoBottom = -static_cast<float>(swapChain.height()) / 2.0f;
@@ -397,23 +431,20 @@ namespace Paddle {
 
 		fontPipeline->bind(commandBuffer);
 
-		const auto& fontFamilies = fontsTable;
-		for (const auto& kv : fontFamilies) {
-			FontFamily family = kv.first;
+		if (imageIndex >= frameBuffers.size()) return;
 
-			const auto& vertices = fontsTable[family].verticesInstance;
-			const auto vertexBuffer = fontsTable[family].vertexBuffer;
-			const auto& descriptorSets = fontsTable[family].fontDescriptorSets;
-			if (vertices.empty()) continue;
+		const auto& frameBuffer = frameBuffers[imageIndex];
+		if (frameBuffer.vertexCount == 0) return;
 
-			const VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
+		const VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frameBuffer.buffer, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
 
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, fontPipelineLayout, 0, 1, &descriptorSets, 0, nullptr);
+		bindless.Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, fontPipelineLayout);
 
-			vkCmdPushConstants(commandBuffer, fontPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &ortho);
+		const FontPushConstants pushConstants{ ortho, fontTextureIndex };
+		vkCmdPushConstants(commandBuffer, fontPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pushConstants), &pushConstants);
 
-			vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-		}
+		vkCmdDrawIndexed(commandBuffer, frameBuffer.vertexCount / 4 * 6, 1, 0, 0, 0);
 	}
 }
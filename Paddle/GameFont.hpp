@@ -6,9 +6,13 @@
 
 #include "VkDevice.hpp"
 #include "VkPipeline.hpp"
+#include "VkBindless.hpp"
+#include "PipelineRegistry.hpp"
 #include "VkSwapChain.hpp"
 #include "GameVertex.hpp"
+#include "AssetLoader.hpp"
 
+#include <array>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -19,6 +23,12 @@ namespace Paddle {
 		FONT_FAMILY_BODY,
 	};
 
+	static constexpr size_t FONT_FAMILY_COUNT = 2;
+
+	// Glyphs are indexed quads with 16 bit indices, so 65536 / 4 is the most
+	// one frame can show. AddText() drops anything past it.
+	static constexpr uint32_t MAX_TEXT_GLYPHS = 16384;
+
 	struct FontFamilyHasher {
 		std::size_t operator()(const FontFamily& k) const noexcept {
 			return static_cast<std::size_t>(k);
@@ -28,36 +38,41 @@ namespace Paddle {
 	struct FontFamilyData {
 		// --- Font metadata ---
 		std::string filePath;
-		stbtt_fontinfo fontInfo;
 		stbtt_bakedchar bakedChars[96];
-		unsigned char* bitmap = nullptr;
+		int atlasOffsetY = 0; // Where this family's glyphs start in the shared atlas
+		float layoutScale = 1.0f; // Atlas pixels to AddText() units
 		int fontAscent = 0;
+	};
 
-		// --- Staging buffer ---
-		VkBuffer stagingBuffer = VK_NULL_HANDLE;
-		VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+	// Text laid out by the simulation for one frame. Every family samples
+	// the same atlas, so all of it goes out in one buffer and one draw.
+	struct TextSnapshot {
+		std::vector<TextVertex> vertices; // 4 per glyph
+	};
 
-		// --- Vulkan resources for ---
-		VkImage fontImage = VK_NULL_HANDLE;
-		VkDeviceMemory fontImageMemory = VK_NULL_HANDLE;
-		VkImageView fontImageView = VK_NULL_HANDLE;
-		VkSampler fontSampler = VK_NULL_HANDLE;
-		VkDescriptorSet fontDescriptorSets;
-		VkBuffer vertexBuffer = VK_NULL_HANDLE;
-		VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
-		std::vector<Vertex> verticesInstance;
+	// Vertex storage for one swapchain image. Only the render thread touches
+	// these, and only after the image's last submit retired.
+	struct FontFrameBuffer {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		void* mapped = nullptr;
+		VkDeviceSize capacity = 0;
+		uint32_t vertexCount = 0;
 	};
 
 
 	class GameFont {
 	public:
-		GameFont(Vk::Device& device, VkDescriptorPool& descriptorPool, Vk::SwapChain& swapChain);
+		GameFont(Vk::Device& device, Vk::BindlessDescriptors& bindless, Vk::SwapChain& swapChain, AssetLoader& assets, PipelineRegistry& pipelines);
 		~GameFont();
 
+		// Queues font baking and shader reads so they run while the device comes up.
+		static void Prefetch(AssetLoader& assets);
+
 		GameFont(const GameFont&) = delete;
 		GameFont& operator=(const GameFont&) = delete;
 
-		void Draw(VkCommandBuffer commandBuffer);
+		void Draw(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
 		void AddText(FontFamily family, const std::string& text, float x, float y, float scale, glm::vec3 color);
 		void AddText(FontFamily family, const std::string& text) {
@@ -67,24 +82,55 @@ namespace Paddle {
 		void ClearText();
 		void SetText(FontFamily family, const std::string& text, float x, float y, float scale, glm::vec3 color);
 
-		void CreateVertexBuffer();
+		// === Simulation side ===
+		void CopyText(TextSnapshot& snapshot) const;
+
+		// === Render side ===
+		void UploadText(uint32_t imageIndex, const TextSnapshot& snapshot);
 		void CreatePipeline();
 
+		// Bumped whenever the image's vertex buffer, vertex count or the
+		// pipeline change, so recorded command buffers know they went stale.
+		uint64_t GetVersion(uint32_t imageIndex) const {
+			return imageIndex < imageVersions.size() ? imageVersions[imageIndex] : 0;
+		}
+
 	private:
 		Vk::Device& device;
-		VkDescriptorPool& descriptorPool;
-		VkDescriptorSetLayout descriptorSetLayout;
+		Vk::BindlessDescriptors& bindless;
 		Vk::SwapChain& swapChain;
-		Vk::Pipeline* fontPipeline = nullptr;
+		AssetLoader& assets;
+		PipelineRegistry& pipelines;
+		Vk::Pipeline* fontPipeline = nullptr; // Owned by pipelines
 		VkPipelineLayout fontPipelineLayout = VK_NULL_HANDLE;
 
-		int texWidth, texHeight;
+		std::vector<FontFrameBuffer> frameBuffers;
+		std::vector<uint64_t> imageVersions;
 		std::unordered_map<FontFamily, std::string, FontFamilyHasher> fontFilePath;
 		std::unordered_map<FontFamily, FontFamilyData, FontFamilyHasher> fontsTable;
+		std::vector<TextVertex> verticesInstance;
+
+		// Shared by every image, 0 1 2 2 1 3 for each glyph quad. Never changes.
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+
+		// --- Shared SDF atlas, every family stacked into one page ---
+		std::vector<unsigned char> atlasPixels;
+		int atlasWidth = 0;
+		int atlasHeight = 0;
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory stagingBufferMemory = VK_NULL_HANDLE;
+		VkImage fontImage = VK_NULL_HANDLE;
+		VkDeviceMemory fontImageMemory = VK_NULL_HANDLE;
+		VkImageView fontImageView = VK_NULL_HANDLE;
+		VkSampler fontSampler = VK_NULL_HANDLE;
+		uint32_t fontTextureIndex = 0; // Atlas slot in the bindless set
 
 		void CreateFonts();
 		void CreateFontBuffers();
+		void CreateIndexBuffer();
 		void CreatePipelineLayout();
-		void CreateDescriptorSet();
+		void RegisterTexture();
+		void DestroyFrameBuffer(FontFrameBuffer& frameBuffer);
 	};
 }
@@ -1,106 +1,572 @@
 #include "GameSounds.hpp"
+#include "Utils.hpp"
 
+// Streamed sounds keep two pages decoded ahead of the playhead, 2 x 250ms
+// keeps the BGM's resident buffer small whatever the track length.
+#define MA_RESOURCE_MANAGER_PAGE_SIZE_IN_MILLISECONDS 250
 #define MINIAUDIO_IMPLEMENTATION
 #include "Vendor\miniaudio.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <stdexcept>
+#include <string>
+
+using Utils::DebugLog;
 
 namespace Paddle {
-	const std::string prefix = "Assets\\Audio\\";
+	const std::string prefix = "Assets/Audio/";
 
-	GameSounds::GameSounds() {
-		ma_result result;
+	// Voices mixed at once across every effect. Anything over budget either
+	// replaces a lower priority voice or never reaches the mixer.
+	static constexpr uint32_t MAX_ACTIVE_VOICES = 12;
 
-		result = ma_engine_init(NULL, &engine);
-		if (result != MA_SUCCESS) {
-			throw std::runtime_error("failed to initialize sound");
+	// Repeat triggers of one effect closer than this are heard as one.
+	// Measured on the engine clock so offline renders coalesce the same way.
+	static constexpr int64_t SFX_COALESCE_WINDOW_MS = 30;
+
+	static constexpr uint32_t OFFLINE_CHANNELS    = 2;
+	static constexpr uint32_t OFFLINE_SAMPLE_RATE = 48000;
+
+	struct SfxDesc {
+		const char* filename;
+		uint32_t polyphony; // Voices that can play at once before the oldest gets stolen
+		int priority;       // Higher survives the global voice cap
+		bool looping;
+	};
+
+	// Indexed by GameSoundsSfx.
+	static const SfxDesc SFX_TABLE[SFX_COUNT] = {
+		{ "paddle-bounce.mp3",   2, 60,  false }, // SFX_PADDLE_BOUNCE
+		{ "wall-bounce.mp3",     2, 40,  false }, // SFX_WALL_BOUNCE
+		{ "blocks-reset.wav",    1, 90,  false }, // SFX_BLOCKS_RESET
+		{ "game-over.wav",       1, 100, false }, // SFX_GAME_OVER
+		{ "block-explosion.wav", 4, 20,  false }, // SFX_BLOCK_EXPLOSION
+		{ "bonus.wav",           2, 50,  false }, // SFX_BONUS
+		{ "loot-pickup.mp3",     2, 70,  false }, // SFX_LOOT_PICKUP
+		{ "loot-denied.wav",     2, 70,  false }, // SFX_LOOT_DENIED
+		{ "bullet.wav",          1, 80,  true  }, // SFX_BULLET, loops while active
+	};
+
+	static int64_t SteadyNowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	//
+	// Asset VFS
+	//
+
+	struct AssetVfsFile {
+		AssetFile file;
+		size_t cursor = 0;
+	};
+
+	static ma_result AssetVfsOpen(ma_vfs* pVFS, const char* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile) {
+		if (pFile == NULL || pFilePath == NULL) return MA_INVALID_ARGS;
+		*pFile = NULL;
+		if ((openMode & MA_OPEN_MODE_WRITE) != 0) return MA_NOT_IMPLEMENTED;
+
+		const AssetVfs* vfs = static_cast<const AssetVfs*>(pVFS);
+		auto* handle = new AssetVfsFile();
+		if (!vfs->files->Open(pFilePath, handle->file)) {
+			delete handle;
+			return MA_DOES_NOT_EXIST;
 		}
 
+		*pFile = handle;
+		return MA_SUCCESS;
+	}
+
+	static ma_result AssetVfsOpenW(ma_vfs* pVFS, const wchar_t* pFilePath, ma_uint32 openMode, ma_vfs_file* pFile) {
+		(void)pVFS; (void)pFilePath; (void)openMode;
+		if (pFile != NULL) *pFile = NULL;
+		return MA_NOT_IMPLEMENTED; // Virtual paths are always narrow
+	}
+
+	static ma_result AssetVfsClose(ma_vfs* pVFS, ma_vfs_file file) {
+		(void)pVFS;
+		delete static_cast<AssetVfsFile*>(file);
+		return MA_SUCCESS;
+	}
+
+	static ma_result AssetVfsRead(ma_vfs* pVFS, ma_vfs_file file, void* pDst, size_t sizeInBytes, size_t* pBytesRead) {
+		(void)pVFS;
+		auto* handle = static_cast<AssetVfsFile*>(file);
+
+		const size_t bytesRead = std::min(sizeInBytes, handle->file.Size() - handle->cursor);
+		memcpy(pDst, handle->file.Data() + handle->cursor, bytesRead);
+		handle->cursor += bytesRead;
+
+		if (pBytesRead != NULL) *pBytesRead = bytesRead;
+		return (bytesRead == 0 && sizeInBytes > 0) ? MA_AT_END : MA_SUCCESS;
+	}
+
+	static ma_result AssetVfsWrite(ma_vfs* pVFS, ma_vfs_file file, const void* pSrc, size_t sizeInBytes, size_t* pBytesWritten) {
+		(void)pVFS; (void)file; (void)pSrc; (void)sizeInBytes;
+		if (pBytesWritten != NULL) *pBytesWritten = 0;
+		return MA_NOT_IMPLEMENTED;
+	}
+
+	static ma_result AssetVfsSeek(ma_vfs* pVFS, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin) {
+		(void)pVFS;
+		auto* handle = static_cast<AssetVfsFile*>(file);
+
+		ma_int64 base = 0;
+		if (origin == ma_seek_origin_current) base = static_cast<ma_int64>(handle->cursor);
+		else if (origin == ma_seek_origin_end) base = static_cast<ma_int64>(handle->file.Size());
+
+		const ma_int64 target = base + offset;
+		if (target < 0 || target > static_cast<ma_int64>(handle->file.Size())) return MA_BAD_SEEK;
+
+		handle->cursor = static_cast<size_t>(target);
+		return MA_SUCCESS;
+	}
+
+	static ma_result AssetVfsTell(ma_vfs* pVFS, ma_vfs_file file, ma_int64* pCursor) {
+		(void)pVFS;
+		*pCursor = static_cast<ma_int64>(static_cast<AssetVfsFile*>(file)->cursor);
+		return MA_SUCCESS;
+	}
+
+	static ma_result AssetVfsInfo(ma_vfs* pVFS, ma_vfs_file file, ma_file_info* pInfo) {
+		(void)pVFS;
+		pInfo->sizeInBytes = static_cast<AssetVfsFile*>(file)->file.Size();
+		return MA_SUCCESS;
+	}
+
+	GameSounds::GameSounds(const AudioConfig& config, const AssetFileSystem& files) : offline(config.offline) {
+		ma_result result;
+
+		vfs.callbacks.onOpen  = AssetVfsOpen;
+		vfs.callbacks.onOpenW = AssetVfsOpenW;
+		vfs.callbacks.onClose = AssetVfsClose;
+		vfs.callbacks.onRead  = AssetVfsRead;
+		vfs.callbacks.onWrite = AssetVfsWrite;
+		vfs.callbacks.onSeek  = AssetVfsSeek;
+		vfs.callbacks.onTell  = AssetVfsTell;
+		vfs.callbacks.onInfo  = AssetVfsInfo;
+		vfs.files = &files;
+
+		if (offline) InitOfflineEngine();
+		else InitDeviceEngine(config);
+
+		// On a device the load is async: init returns right away and the
+		// resource manager's job thread reads the file, so startup never
+		// waits on the track. Until the first page is ready it plays silence.
+		// Offline renders load up front and decode stream pages inside
+		// RenderOffline(), so every run mixes the same audio and pays for it.
+		ma_uint32 bgmFlags = config.bgmLoadMode == BGM_LOAD_PRELOAD ? MA_SOUND_FLAG_DECODE : MA_SOUND_FLAG_STREAM;
+		if (!offline) bgmFlags |= MA_SOUND_FLAG_ASYNC;
+
 		const std::string bgmPath = prefix + "bg-music.wav";
-		result = ma_sound_init_from_file(&engine, bgmPath.c_str(), 0, NULL, NULL, &bgm);
+		result = ma_sound_init_from_file(&engine, bgmPath.c_str(), bgmFlags, NULL, NULL, &bgm);
 		if (result != MA_SUCCESS) {
 			throw std::runtime_error("failed to load bg music");
 		}
 		ma_sound_set_volume(&bgm, 0.8f);
 		ma_sound_set_looping(&bgm, MA_TRUE);
+
+		for (int sfx = 0; sfx < SFX_COUNT; ++sfx)
+			CreateVoicePool(static_cast<GameSoundsSfx>(sfx));
+
+		if (offline) return;
+
+		result = ma_device_start(&device);
+		if (result != MA_SUCCESS) {
+			throw std::runtime_error("failed to start audio device");
+		}
+
+		audioThreadRunning = true;
+		audioThread = std::thread(&GameSounds::AudioLoop, this);
+	}
+
+	void GameSounds::InitDeviceEngine(const AudioConfig& config) {
+		ma_result result;
+
+		// Owned here rather than by the engine so the period layout can be
+		// set and the callback can time when triggers actually get mixed.
+		ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
+		deviceConfig.playback.format           = ma_format_f32;
+		deviceConfig.dataCallback              = DataCallback;
+		deviceConfig.pUserData                 = this;
+		deviceConfig.noPreSilencedOutputBuffer = MA_TRUE; // The engine writes every frame
+		deviceConfig.noClip                    = MA_TRUE; // and clips itself
+		if (config.lowLatency) {
+			deviceConfig.performanceProfile = ma_performance_profile_low_latency;
+			deviceConfig.periodSizeInFrames = config.periodSizeInFrames;
+			deviceConfig.periods            = config.periodCount;
+		}
+
+		result = ma_device_init(NULL, &deviceConfig, &device);
+		if (result != MA_SUCCESS) {
+			throw std::runtime_error("failed to initialize audio device");
+		}
+
+		// What the backend actually granted, which may differ from the request.
+		bufferLatencyMs = 1000.0f * device.playback.internalPeriodSizeInFrames * device.playback.internalPeriods / device.playback.internalSampleRate;
+		DebugLog("Audio device: " + std::to_string(device.playback.internalPeriodSizeInFrames) + " frames x " +
+			std::to_string(device.playback.internalPeriods) + " periods @ " +
+			std::to_string(device.playback.internalSampleRate) + "Hz (" + std::to_string(bufferLatencyMs) + "ms buffer)");
+
+		ma_engine_config engineConfig = ma_engine_config_init();
+		engineConfig.pDevice = &device;
+		engineConfig.noAutoStart = MA_TRUE;
+		engineConfig.pResourceManagerVFS = &vfs;
+
+		result = ma_engine_init(&engineConfig, &engine);
+		if (result != MA_SUCCESS) {
+			ma_device_uninit(&device);
+			throw std::runtime_error("failed to initialize sound");
+		}
+	}
+
+	void GameSounds::InitOfflineEngine() {
+		// Without a job thread, so no decoding happens behind the caller's
+		// back. Set up like the one ma_engine would create for itself.
+		ma_resource_manager_config resourceManagerConfig = ma_resource_manager_config_init();
+		resourceManagerConfig.decodedFormat     = ma_format_f32;
+		resourceManagerConfig.decodedSampleRate = OFFLINE_SAMPLE_RATE;
+		resourceManagerConfig.jobThreadCount    = 0;
+		resourceManagerConfig.flags             = MA_RESOURCE_MANAGER_FLAG_NO_THREADING;
+		resourceManagerConfig.pVFS              = &vfs;
+
+		if (ma_resource_manager_init(&resourceManagerConfig, &resourceManager) != MA_SUCCESS) {
+			throw std::runtime_error("failed to initialize offline resource manager");
+		}
+
+		ma_engine_config engineConfig = ma_engine_config_init();
+		engineConfig.noDevice   = MA_TRUE;
+		engineConfig.channels   = OFFLINE_CHANNELS;
+		engineConfig.sampleRate = OFFLINE_SAMPLE_RATE;
+		engineConfig.pResourceManager = &resourceManager;
+
+		if (ma_engine_init(&engineConfig, &engine) != MA_SUCCESS) {
+			ma_resource_manager_uninit(&resourceManager);
+			throw std::runtime_error("failed to initialize offline sound engine");
+		}
 	}
 
 	GameSounds::~GameSounds() {
-                if(bulletSoundInitialized) ma_sound_uninit(&bulletSound);
+		if (!offline) {
+			audioThreadRunning = false;
+			audioThread.join();
+		}
+
+		if (droppedCommands > 0)
+			DebugLog("Audio command queue overflowed, dropped " + std::to_string(droppedCommands) + " commands.");
+		DebugLog("Sfx triggers coalesced: " + std::to_string(coalescedTriggers) +
+			", culled: " + std::to_string(culledTriggers) +
+			", voices stolen: " + std::to_string(stolenVoices));
+
+		if (!offline) {
+			const AudioLatencyStats latency = GetLatencyStats();
+			DebugLog("Sfx output latency: avg " + std::to_string(latency.averageOutputLatencyMs) +
+				"ms, max " + std::to_string(latency.maxOutputLatencyMs) +
+				"ms over " + std::to_string(latency.sampleCount) + " triggers.");
+
+			// Stop the callback before tearing down what it reads.
+			ma_device_stop(&device);
+		}
+
+		for (auto& pool : sfxPools) DestroyVoicePool(pool);
 
 		ma_sound_uninit(&bgm);
 		ma_engine_uninit(&engine);
+		if (offline) ma_resource_manager_uninit(&resourceManager);
+		else ma_device_uninit(&device);
 	}
 
-	void GameSounds::PauseBgm() {
-		ma_sound_stop(&bgm);
+	void GameSounds::RenderOffline(float* output, uint32_t frameCount) {
+		if (!offline) throw std::runtime_error("RenderOffline needs an offline GameSounds");
+
+		ApplyPendingCommands();
+
+		// Refills the stream pages the previous chunk used up. Nothing else
+		// runs the queue without a job thread.
+		while (ma_resource_manager_process_next_job(&resourceManager) == MA_SUCCESS) { }
+
+		ma_engine_read_pcm_frames(&engine, output, frameCount, NULL);
 	}
 
-	void GameSounds::PlayBgm() {
-		ma_sound_start(&bgm);
+	//
+	// Device callback (audio thread owned by miniaudio)
+	//
+
+	void GameSounds::DataCallback(ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
+		(void)input;
+		auto* sounds = static_cast<GameSounds*>(device->pUserData);
+
+		// Whatever got triggered since the last callback is mixed in this one.
+		const int64_t triggerTime = sounds->pendingTriggerTime.exchange(0, std::memory_order_acq_rel);
+		if (triggerTime != 0) {
+			const int64_t latencyNs = SteadyNowNs() - triggerTime;
+			sounds->latencySamples.fetch_add(1, std::memory_order_relaxed);
+			sounds->latencySumNs.fetch_add(latencyNs, std::memory_order_relaxed);
+
+			int64_t currentMax = sounds->latencyMaxNs.load(std::memory_order_relaxed);
+			while (latencyNs > currentMax &&
+				!sounds->latencyMaxNs.compare_exchange_weak(currentMax, latencyNs, std::memory_order_relaxed)) { }
+		}
+
+		ma_engine_read_pcm_frames(&sounds->engine, output, frameCount, NULL);
+	}
+
+	AudioLatencyStats GameSounds::GetLatencyStats() const {
+		AudioLatencyStats stats;
+		stats.bufferLatencyMs = bufferLatencyMs;
+		stats.sampleCount = latencySamples.load(std::memory_order_relaxed);
+		if (stats.sampleCount == 0) return stats;
+
+		const float averageMixMs = latencySumNs.load(std::memory_order_relaxed) / 1.0e6f / stats.sampleCount;
+		const float maxMixMs = latencyMaxNs.load(std::memory_order_relaxed) / 1.0e6f;
+		stats.averageOutputLatencyMs = averageMixMs + bufferLatencyMs;
+		stats.maxOutputLatencyMs = maxMixMs + bufferLatencyMs;
+		return stats;
+	}
+
+	//
+	// Voice pools
+	//
+
+	void GameSounds::CreateVoicePool(GameSoundsSfx sfx) {
+		const SfxDesc& desc = SFX_TABLE[sfx];
+		SfxVoicePool& pool = sfxPools[sfx];
+
+		pool.voices = new ma_sound[desc.polyphony];
+		pool.startOrder = new uint64_t[desc.polyphony]();
+		pool.looping = desc.looping;
+		pool.priority = desc.priority;
+
+		// The first voice decodes the whole file to PCM, the copies only
+		// reference the resource manager's buffer.
+		const std::string fullPath = prefix + desc.filename;
+		ma_result result = ma_sound_init_from_file(&engine, fullPath.c_str(), MA_SOUND_FLAG_DECODE, NULL, NULL, &pool.voices[0]);
+		if (result != MA_SUCCESS) {
+			// A missing effect shouldn't take the game down; it just stays silent.
+			DebugLog("Failed to load sound effect " + fullPath);
+			return;
+		}
+		pool.voiceCount = 1;
+
+		for (uint32_t i = 1; i < desc.polyphony; ++i) {
+			result = ma_sound_init_copy(&engine, &pool.voices[0], 0, NULL, &pool.voices[i]);
+			if (result != MA_SUCCESS) {
+				DebugLog("Failed to create voice for " + fullPath);
+				break;
+			}
+			pool.voiceCount++;
+		}
+
+		for (uint32_t i = 0; i < pool.voiceCount; ++i)
+			ma_sound_set_looping(&pool.voices[i], pool.looping ? MA_TRUE : MA_FALSE);
+
+		DebugLog("Loaded " + fullPath + " with " + std::to_string(pool.voiceCount) + " voices.");
+	}
+
+	void GameSounds::DestroyVoicePool(SfxVoicePool& pool) {
+		for (uint32_t i = 0; i < pool.voiceCount; ++i)
+			ma_sound_uninit(&pool.voices[i]);
+
+		delete[] pool.voices;
+		delete[] pool.startOrder;
+		pool.voices = nullptr;
+		pool.startOrder = nullptr;
+		pool.voiceCount = 0;
+	}
+
+	bool GameSounds::AcquireVoice(SfxVoicePool& pool, uint32_t& voice) {
+		// Effect already at its instance cap: recycle whichever of its own
+		// voices started longest ago, the global count doesn't change.
+		uint32_t oldest = 0;
+		bool foundIdle = false;
+		for (uint32_t i = 0; i < pool.voiceCount; ++i) {
+			if (!ma_sound_is_playing(&pool.voices[i])) {
+				voice = i;
+				foundIdle = true;
+				break;
+			}
+			if (pool.startOrder[i] < pool.startOrder[oldest]) oldest = i;
+		}
+
+		if (!foundIdle) {
+			ma_sound_stop(&pool.voices[oldest]);
+			voice = oldest;
+			++stolenVoices;
+			return true;
+		}
+
+		// A new voice joins the mix, make room under the global cap or
+		// cull the trigger if everything playing matters more.
+		if (CountActiveVoices() < MAX_ACTIVE_VOICES) return true;
+		if (StealVoiceBelow(pool.priority)) return true;
+
+		++culledTriggers;
+		return false;
+	}
+
+	uint32_t GameSounds::CountActiveVoices() {
+		uint32_t active = 0;
+		for (auto& pool : sfxPools) {
+			for (uint32_t i = 0; i < pool.voiceCount; ++i)
+				if (ma_sound_is_playing(&pool.voices[i])) ++active;
+		}
+		return active;
+	}
+
+	bool GameSounds::StealVoiceBelow(int priority) {
+		SfxVoicePool* victimPool = nullptr;
+		uint32_t victim = 0;
+
+		// Lowest priority first, oldest among equals.
+		for (auto& pool : sfxPools) {
+			if (pool.priority >= priority) continue;
+
+			for (uint32_t i = 0; i < pool.voiceCount; ++i) {
+				if (!ma_sound_is_playing(&pool.voices[i])) continue;
+
+				if (!victimPool || pool.priority < victimPool->priority ||
+					(pool.priority == victimPool->priority && pool.startOrder[i] < victimPool->startOrder[victim])) {
+					victimPool = &pool;
+					victim = i;
+				}
+			}
+		}
+
+		if (!victimPool) return false;
+
+		ma_sound_stop(&victimPool->voices[victim]);
+		++stolenVoices;
+		return true;
 	}
 
+	//
+	// Game thread: queue commands
+	//
+
 	void GameSounds::PlaySfx(GameSoundsSfx sfx) {
-		std::string filename;
-
-		switch (sfx) {
-                case SFX_BULLET: {
-                        if (!bulletSoundInitialized) {
-                            std::string fullPath = prefix + "bullet.wav";
-                            ma_result result = ma_sound_init_from_file(&engine, fullPath.c_str(), 0, NULL, NULL, &bulletSound);
-                            if (result != MA_SUCCESS) {
-                                std::cerr << "Failed to load bullet sound\n";
-                                return;
-                            }
-                            bulletSoundInitialized = true;
-                            ma_sound_set_looping(&bulletSound, MA_TRUE); // Loop while active
-                        }
-                        ma_sound_start(&bulletSound);
-                        return;
-                }
-		case SFX_PADDLE_BOUNCE:
-			filename = "paddle-bounce.mp3";
-			break;
-		case SFX_WALL_BOUNCE:
-			filename = "wall-bounce.mp3";
-			break;
-		case SFX_BLOCKS_RESET:
-			filename = "blocks-reset.wav";
-			break;
-		case SFX_GAME_OVER:
-			filename = "game-over.wav";
+		Push(AUDIO_COMMAND_PLAY_SFX, sfx, 0.0f);
+	}
+
+	void GameSounds::StopSfx(GameSoundsSfx sfx) {
+		Push(AUDIO_COMMAND_STOP_SFX, sfx, 0.0f);
+	}
+
+	void GameSounds::SetSfxVolume(GameSoundsSfx sfx, float volume) {
+		Push(AUDIO_COMMAND_SET_SFX_VOLUME, sfx, volume);
+	}
+
+	void GameSounds::PlayBgm() {
+		Push(AUDIO_COMMAND_PLAY_BGM, SFX_COUNT, 0.0f);
+	}
+
+	void GameSounds::PauseBgm() {
+		Push(AUDIO_COMMAND_PAUSE_BGM, SFX_COUNT, 0.0f);
+	}
+
+	void GameSounds::SetBgmVolume(float volume) {
+		Push(AUDIO_COMMAND_SET_BGM_VOLUME, SFX_COUNT, volume);
+	}
+
+	void GameSounds::Push(AudioCommandType type, GameSoundsSfx sfx, float volume) {
+		// A full queue means the audio thread is far behind; losing a sound
+		// beats stalling the frame.
+		if (!commands.TryPush(AudioCommand{ type, sfx, volume, SteadyNowNs() })) ++droppedCommands;
+	}
+
+	//
+	// Audio thread: apply commands
+	//
+
+	void GameSounds::AudioLoop() {
+		// Polling keeps the producer side free of locks and syscalls; a 1ms
+		// nap is well under one audio period.
+		while (audioThreadRunning) {
+			if (!ApplyPendingCommands()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	bool GameSounds::ApplyPendingCommands() {
+		AudioCommand command;
+		bool applied = false;
+		while (commands.TryPop(command)) {
+			ApplyCommand(command);
+			applied = true;
+		}
+		return applied;
+	}
+
+	void GameSounds::ApplyCommand(const AudioCommand& command) {
+		switch (command.type) {
+		case AUDIO_COMMAND_PLAY_SFX:
+			ApplyPlaySfx(command.sfx, command.issuedAt);
 			break;
-		case SFX_BLOCK_EXPLOSION:
-			filename = "block-explosion.wav";
+		case AUDIO_COMMAND_STOP_SFX:
+			ApplyStopSfx(command.sfx);
 			break;
-		case SFX_BONUS:
-			filename = "bonus.wav";
+		case AUDIO_COMMAND_SET_SFX_VOLUME:
+			ApplySfxVolume(command.sfx, command.volume);
 			break;
-		case SFX_LOOT_PICKUP:
-			filename = "loot-pickup.wav";
+		case AUDIO_COMMAND_PLAY_BGM:
+			ma_sound_start(&bgm);
 			break;
-		case SFX_LOOT_DENIED:
-			filename = "loot-denied.mp3";
+		case AUDIO_COMMAND_PAUSE_BGM:
+			ma_sound_stop(&bgm);
 			break;
-		default:
-			std::cerr << "unknown sound fx" << std::endl;
-			filename = "wall-bounce.mp3";
+		case AUDIO_COMMAND_SET_BGM_VOLUME:
+			ma_sound_set_volume(&bgm, command.volume);
 			break;
 		}
+	}
+
+	void GameSounds::ApplyPlaySfx(GameSoundsSfx sfx, int64_t issuedAt) {
+		if (sfx < 0 || sfx >= SFX_COUNT) {
+			DebugLog("Unknown sound fx " + std::to_string(sfx));
+			return;
+		}
+
+		SfxVoicePool& pool = sfxPools[sfx];
+		if (pool.voiceCount == 0) return;
 
-		std::string fullPath = prefix + filename;
-		ma_engine_play_sound(&engine, fullPath.c_str(), NULL);
+		// Looping effects keep running until StopSfx(), don't restart them.
+		if (pool.looping && ma_sound_is_playing(&pool.voices[0])) return;
+
+		// A burst of identical triggers (a chain of TNT blocks) sounds no
+		// different as one voice and costs the mixer far less.
+		const int64_t now = static_cast<int64_t>(ma_engine_get_time_in_milliseconds(&engine));
+		if (now - pool.lastTriggerMs < SFX_COALESCE_WINDOW_MS) {
+			++coalescedTriggers;
+			return;
+		}
+
+		uint32_t voice;
+		if (!AcquireVoice(pool, voice)) return;
+
+		pool.startOrder[voice] = ++triggerCount;
+		pool.lastTriggerMs = now;
+
+		ma_sound_seek_to_pcm_frame(&pool.voices[voice], 0);
+		ma_sound_start(&pool.voices[voice]);
+
+		// Keep the oldest unmixed trigger, that's the one that waits longest.
+		int64_t noTrigger = 0;
+		pendingTriggerTime.compare_exchange_strong(noTrigger, issuedAt, std::memory_order_acq_rel);
 	}
 
-        void GameSounds::StopSfx(GameSoundsSfx sfx) {
-                switch (sfx) {
-                        case SFX_BULLET:
-                                if (bulletSoundInitialized) ma_sound_stop(&bulletSound);
-                                break;
-                        default:
-                                std::cerr << "StopSfx not implemented for this sound effect\n";
-                                break;
-                }
-        }
+	void GameSounds::ApplyStopSfx(GameSoundsSfx sfx) {
+		if (sfx < 0 || sfx >= SFX_COUNT) return;
+
+		SfxVoicePool& pool = sfxPools[sfx];
+		for (uint32_t i = 0; i < pool.voiceCount; ++i)
+			ma_sound_stop(&pool.voices[i]);
+	}
+
+	void GameSounds::ApplySfxVolume(GameSoundsSfx sfx, float volume) {
+		if (sfx < 0 || sfx >= SFX_COUNT) return;
+
+		SfxVoicePool& pool = sfxPools[sfx];
+		for (uint32_t i = 0; i < pool.voiceCount; ++i)
+			ma_sound_set_volume(&pool.voices[i], volume);
+	}
 }
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "Vendor\miniaudio.h"
+#include "AssetPack.hpp"
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
 
 namespace Paddle {
 	enum GameSoundsSfx {
@@ -12,24 +18,147 @@ namespace Paddle {
 		SFX_BONUS,
 		SFX_LOOT_PICKUP,
 		SFX_LOOT_DENIED,
-                SFX_BULLET
+		SFX_BULLET,
+		SFX_COUNT
+	};
+
+	// Pre-initialized voices for one effect. All of them share a single
+	// decoded PCM buffer owned by the engine's resource manager.
+	struct SfxVoicePool {
+		ma_sound* voices = nullptr;
+		uint64_t* startOrder = nullptr; // When each voice was last triggered, 0 if never
+		uint32_t voiceCount = 0;
+		bool looping = false;
+		int priority = 0;
+		int64_t lastTriggerMs = INT64_MIN / 2; // Engine clock, far in the past until first played
+	};
+
+	enum BgmLoadMode {
+		BGM_LOAD_STREAM = 0, // Decode a little ahead of playback on a background thread
+		BGM_LOAD_PRELOAD     // Decode the whole track into memory up front
+	};
+
+	struct AudioConfig {
+		BgmLoadMode bgmLoadMode = BGM_LOAD_STREAM;
+
+		// Low latency asks the backend for these exact periods instead of
+		// letting it pick (which tends to be ~10ms x 3 on WASAPI shared).
+		bool lowLatency = false;
+		uint32_t periodSizeInFrames = 256;
+		uint32_t periodCount = 2;
+
+		// No device at all: the engine only mixes when RenderOffline() asks,
+		// and commands are applied (and streams decoded) by that caller
+		// instead of an audio thread.
+		bool offline = false;
+	};
+
+	// Output latency as measured while playing. Trigger-to-mix is the time
+	// from PlaySfx() on the game thread to the first device callback mixing
+	// it; the device buffer then adds bufferLatencyMs before it's audible.
+	struct AudioLatencyStats {
+		float bufferLatencyMs = 0.0f;
+		float averageOutputLatencyMs = 0.0f;
+		float maxOutputLatencyMs = 0.0f;
+		uint64_t sampleCount = 0;
+	};
+
+	enum AudioCommandType {
+		AUDIO_COMMAND_PLAY_SFX = 0,
+		AUDIO_COMMAND_STOP_SFX,
+		AUDIO_COMMAND_SET_SFX_VOLUME,
+		AUDIO_COMMAND_PLAY_BGM,
+		AUDIO_COMMAND_PAUSE_BGM,
+		AUDIO_COMMAND_SET_BGM_VOLUME
+	};
+
+	struct AudioCommand {
+		AudioCommandType type;
+		GameSoundsSfx sfx;
+		float volume;
+		int64_t issuedAt; // steady_clock nanoseconds
+	};
+
+	static constexpr size_t AUDIO_COMMAND_QUEUE_SIZE = 256;
+
+	// miniaudio VFS over the asset file system, so the resource manager
+	// decodes (and streams) sounds out of the pack like any other asset.
+	struct AssetVfs {
+		ma_vfs_callbacks callbacks; // Must stay first, miniaudio casts the ma_vfs* to it
+		const AssetFileSystem* files;
 	};
 
+	// The public methods only queue a command; a dedicated audio thread
+	// applies them to miniaudio. They must all be called from one thread
+	// (the simulation), the queue has a single producer.
 	class GameSounds {
 	public:
-		GameSounds();
+		GameSounds(const AudioConfig& config, const AssetFileSystem& files);
 		~GameSounds();
 
+		GameSounds(const GameSounds&) = delete;
+		GameSounds& operator=(const GameSounds&) = delete;
+
 		void PlaySfx(GameSoundsSfx sfx);
 		void PauseBgm();
 		void PlayBgm();
-                void StopSfx(GameSoundsSfx sfx);
+		void StopSfx(GameSoundsSfx sfx);
+		void SetSfxVolume(GameSoundsSfx sfx, float volume);
+		void SetBgmVolume(float volume);
+
+		AudioLatencyStats GetLatencyStats() const;
+
+		// === Offline mode ===
+		// Applies queued commands, then mixes frameCount interleaved f32 frames.
+		void RenderOffline(float* output, uint32_t frameCount);
+		uint32_t GetChannelCount() { return ma_engine_get_channels(&engine); }
+		uint32_t GetSampleRate() { return ma_engine_get_sample_rate(&engine); }
 
 	private:
+		bool offline;
+		AssetVfs vfs; // Outlives the engine's resource manager
+		ma_device device;
+		ma_resource_manager resourceManager; // Offline only, the device engine owns its own
 		ma_engine engine;
 		ma_sound bgm;
 
-                ma_sound bulletSound;
-                bool bulletSoundInitialized = false;
-        };
+		// === Latency measurement ===
+		float bufferLatencyMs = 0.0f;
+		std::atomic<int64_t> pendingTriggerTime{ 0 }; // Oldest trigger not mixed yet, 0 if none
+		std::atomic<uint64_t> latencySamples{ 0 };
+		std::atomic<int64_t> latencySumNs{ 0 };
+		std::atomic<int64_t> latencyMaxNs{ 0 };
+
+		SfxVoicePool sfxPools[SFX_COUNT];
+		uint64_t triggerCount = 0;
+
+		// === Voice budget stats (audio thread) ===
+		uint64_t coalescedTriggers = 0;
+		uint64_t culledTriggers = 0;
+		uint64_t stolenVoices = 0;
+
+		// === Command queue ===
+		SpscRing<AudioCommand, AUDIO_COMMAND_QUEUE_SIZE> commands;
+		uint64_t droppedCommands = 0; // Producer side only
+		std::thread audioThread;
+		std::atomic<bool> audioThreadRunning{ false };
+
+		void InitDeviceEngine(const AudioConfig& config);
+		void InitOfflineEngine();
+		void CreateVoicePool(GameSoundsSfx sfx);
+		void DestroyVoicePool(SfxVoicePool& pool);
+		bool AcquireVoice(SfxVoicePool& pool, uint32_t& voice);
+		uint32_t CountActiveVoices();
+		bool StealVoiceBelow(int priority);
+
+		void Push(AudioCommandType type, GameSoundsSfx sfx, float volume);
+		void AudioLoop();
+		bool ApplyPendingCommands();
+		void ApplyCommand(const AudioCommand& command);
+		void ApplyPlaySfx(GameSoundsSfx sfx, int64_t issuedAt);
+		void ApplyStopSfx(GameSoundsSfx sfx);
+		void ApplySfxVolume(GameSoundsSfx sfx, float volume);
+
+		static void DataCallback(ma_device* device, void* output, const void* input, ma_uint32 frameCount);
+	};
 }
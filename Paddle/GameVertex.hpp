@@ -2,9 +2,12 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
+// Mesh vertex as authored on the CPU. Never uploaded as is, see
+// VertexFormat.hpp for what the GPU gets. Color comes from the entity tint.
 struct Vertex {
 	glm::vec3 pos;
-	glm::vec3 color;
 	glm::vec3 normal;
 	glm::vec2 uv;
 
@@ -21,4 +24,12 @@ struct VertexHasher {
 
 		return h1 ^ (h2 << 1) ^ (h3 << 2);
 	}
-};
\ No newline at end of file
+};
+
+// Screen space glyph corner, 16 bytes. UVs are 16 bit normalized and the
+// color is RGBA8, both unpacked by the vertex input stage.
+struct TextVertex {
+	glm::vec2 pos;
+	uint16_t uv[2];
+	uint32_t color;
+};
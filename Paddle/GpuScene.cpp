@@ -0,0 +1,275 @@
+#include "GpuScene.hpp"
+#include "GameCamera.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using Utils::DebugLog;
+using Utils::DestroyPtr;
+
+namespace Paddle {
+	static const char* CULL_SHADER_PATH = "Shader/cull.comp.spv";
+
+	static constexpr uint32_t CULL_WORKGROUP_SIZE = 64; // local_size_x in cull.comp
+	static constexpr uint32_t CULL_CONSTANT_MIN_DISTANCE = 0;
+
+	// LodBuffer and DrawBuffer in cull.comp start with a count padded to 16
+	// bytes, the array follows.
+	static constexpr VkDeviceSize GPU_BUFFER_HEADER_SIZE = 16;
+
+	struct GpuLod {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float maxPixelSize;
+		uint32_t reserved;
+	};
+
+	// Matches PushConstants in cull.comp, exactly the guaranteed minimum.
+	struct CullPushConstants {
+		glm::vec4 frustumPlanes[6];
+		glm::vec3 cameraPosition;
+		float pixelsPerUnit;
+		uint32_t instanceCount;
+		uint32_t instanceBufferIndex;
+		uint32_t drawBufferIndex;
+		uint32_t lodBufferIndex;
+	};
+	static_assert(sizeof(CullPushConstants) == 128, "Push constants beyond 128 bytes aren't guaranteed");
+
+	GpuScene::GpuScene(Vk::Device& device, Vk::BindlessDescriptors& bindless, AssetLoader& assets, const MeshData& mesh, VertexFormat vertexFormat)
+		: device(device), bindless(bindless) {
+		capacity = std::min(GPU_SCENE_MAX_INSTANCES, device.properties.limits.maxDrawIndirectCount);
+
+		CreateGeometry(mesh, vertexFormat);
+		CreateLodBuffer(mesh);
+		CreateCullPipeline(assets);
+	}
+
+	GpuScene::~GpuScene() {
+		for(auto& frame : frames) {
+			if(frame.instancesMapped) vkUnmapMemory(device.device(), frame.instanceMemory);
+			DestroyBuffer(frame.instanceBuffer, frame.instanceMemory);
+			DestroyBuffer(frame.drawBuffer, frame.drawMemory);
+		}
+
+		DestroyBuffer(vertexBuffer, vertexMemory);
+		DestroyBuffer(indexBuffer, indexMemory);
+		DestroyBuffer(lodBuffer, lodMemory);
+
+		DestroyPtr(cullPipeline);
+		if(cullPipelineLayout != VK_NULL_HANDLE)
+			vkDestroyPipelineLayout(device.device(), cullPipelineLayout, nullptr);
+	}
+
+	void GpuScene::Prefetch(AssetLoader& assets) {
+		assets.PrefetchFile(CULL_SHADER_PATH);
+	}
+
+	//
+	// Shared resources
+	//
+
+	void GpuScene::CreateGeometry(const MeshData& mesh, VertexFormat vertexFormat) {
+		// Uploaded once for every instance, straight out of the mapped file
+		// unless the pipeline wants another vertex format.
+		std::vector<uint8_t> packed;
+		const void* vertexSource = mesh.vertexData;
+		VkDeviceSize vertexSize = static_cast<VkDeviceSize>(mesh.vertexCount) * GetVertexStride(mesh.vertexFormat);
+		if(mesh.vertexFormat != vertexFormat) {
+			packed = PackVertices(vertexFormat, UnpackVertices(mesh.vertexFormat, mesh.vertexData, mesh.vertexCount));
+			vertexSource = packed.data();
+			vertexSize = packed.size();
+		}
+		const VkDeviceSize indexSize = sizeof(uint32_t) * static_cast<VkDeviceSize>(mesh.indexCount);
+
+		void* data;
+		device.createBuffer(
+			vertexSize,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			vertexBuffer,
+			vertexMemory);
+		device.SetObjectName((uint64_t)vertexBuffer, VK_OBJECT_TYPE_BUFFER, "GPU Scene Vertex Buffer");
+		vkMapMemory(device.device(), vertexMemory, 0, vertexSize, 0, &data);
+		memcpy(data, vertexSource, static_cast<size_t>(vertexSize));
+		vkUnmapMemory(device.device(), vertexMemory);
+
+		device.createBuffer(
+			indexSize,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			indexBuffer,
+			indexMemory);
+		device.SetObjectName((uint64_t)indexBuffer, VK_OBJECT_TYPE_BUFFER, "GPU Scene Index Buffer");
+		vkMapMemory(device.device(), indexMemory, 0, indexSize, 0, &data);
+		memcpy(data, mesh.indexData, static_cast<size_t>(indexSize));
+		vkUnmapMemory(device.device(), indexMemory);
+	}
+
+	void GpuScene::CreateLodBuffer(const MeshData& mesh) {
+		std::vector<uint8_t> contents(GPU_BUFFER_HEADER_SIZE + sizeof(GpuLod) * mesh.lods.size(), 0);
+		const uint32_t lodCount = static_cast<uint32_t>(mesh.lods.size());
+		memcpy(contents.data(), &lodCount, sizeof(lodCount));
+		for(size_t level = 0; level < mesh.lods.size(); ++level) {
+			const MeshLod& lod = mesh.lods[level];
+			const GpuLod stored{ lod.firstIndex, lod.indexCount, lod.maxPixelSize, 0 };
+			memcpy(contents.data() + GPU_BUFFER_HEADER_SIZE + level * sizeof(GpuLod), &stored, sizeof(stored));
+		}
+
+		device.createBuffer(
+			contents.size(),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			lodBuffer,
+			lodMemory);
+		device.SetObjectName((uint64_t)lodBuffer, VK_OBJECT_TYPE_BUFFER, "GPU Scene LOD Buffer");
+
+		void* data;
+		vkMapMemory(device.device(), lodMemory, 0, contents.size(), 0, &data);
+		memcpy(data, contents.data(), contents.size());
+		vkUnmapMemory(device.device(), lodMemory);
+
+		lodBufferIndex = bindless.AddStorageBuffer(lodBuffer, 0, contents.size());
+	}
+
+	void GpuScene::CreateCullPipeline(AssetLoader& assets) {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(CullPushConstants);
+
+		const VkDescriptorSetLayout setLayout = bindless.GetLayout();
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if(vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create cull pipeline layout!");
+		}
+
+		Vk::SpecializationConstants specialization;
+		specialization.Set(CULL_CONSTANT_MIN_DISTANCE, CAMERA_NEAR);
+
+		cullPipeline = new Vk::ComputePipeline(device, CULL_SHADER_PATH, assets.GetFile(CULL_SHADER_PATH), cullPipelineLayout, specialization);
+	}
+
+	void GpuScene::DestroyBuffer(VkBuffer& buffer, VkDeviceMemory& memory) {
+		if(buffer != VK_NULL_HANDLE) vkDestroyBuffer(device.device(), buffer, nullptr);
+		if(memory != VK_NULL_HANDLE) vkFreeMemory(device.device(), memory, nullptr);
+		buffer = VK_NULL_HANDLE;
+		memory = VK_NULL_HANDLE;
+	}
+
+	//
+	// Per image
+	//
+
+	void GpuScene::Resize(size_t imageCount) {
+		while(frames.size() < imageCount) {
+			FrameResources frame;
+
+			const VkDeviceSize instanceSize = sizeof(GpuInstance) * static_cast<VkDeviceSize>(capacity);
+			device.createBuffer(
+				instanceSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				frame.instanceBuffer,
+				frame.instanceMemory);
+			device.SetObjectName((uint64_t)frame.instanceBuffer, VK_OBJECT_TYPE_BUFFER, "GPU Scene Instance Buffer");
+			vkMapMemory(device.device(), frame.instanceMemory, 0, instanceSize, 0, &frame.instancesMapped);
+			frame.instanceBufferIndex = bindless.AddStorageBuffer(frame.instanceBuffer, 0, instanceSize);
+
+			const VkDeviceSize drawSize = GPU_BUFFER_HEADER_SIZE + sizeof(VkDrawIndexedIndirectCommand) * static_cast<VkDeviceSize>(capacity);
+			device.createBuffer(
+				drawSize,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				frame.drawBuffer,
+				frame.drawMemory);
+			device.SetObjectName((uint64_t)frame.drawBuffer, VK_OBJECT_TYPE_BUFFER, "GPU Scene Draw Buffer");
+			frame.drawBufferIndex = bindless.AddStorageBuffer(frame.drawBuffer, 0, drawSize);
+
+			frames.push_back(frame);
+		}
+	}
+
+	void GpuScene::UploadInstances(uint32_t imageIndex, const std::vector<GpuInstance>& instances) {
+		if(imageIndex >= frames.size()) return;
+		auto& frame = frames[imageIndex];
+
+		size_t count = instances.size();
+		if(count > capacity) {
+			if(!reportedOverflow) {
+				DebugLog("GPU scene is full, dropping " + std::to_string(count - capacity) + " instances.");
+				reportedOverflow = true;
+			}
+			count = capacity;
+		}
+
+		memcpy(frame.instancesMapped, instances.data(), count * sizeof(GpuInstance));
+		frame.instanceCount = static_cast<uint32_t>(count);
+	}
+
+	void GpuScene::RecordCulling(VkCommandBuffer commandBuffer, uint32_t imageIndex, const DrawView& view) {
+		if(imageIndex >= frames.size()) return;
+		const auto& frame = frames[imageIndex];
+
+		vkCmdFillBuffer(commandBuffer, frame.drawBuffer, 0, sizeof(uint32_t), 0);
+
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		if(frame.instanceCount > 0) {
+			CullPushConstants pushConstants{};
+			for(int i = 0; i < 6; ++i) pushConstants.frustumPlanes[i] = view.frustum.planes[i];
+			pushConstants.cameraPosition      = view.cameraPosition;
+			pushConstants.pixelsPerUnit       = view.pixelsPerUnit;
+			pushConstants.instanceCount       = frame.instanceCount;
+			pushConstants.instanceBufferIndex = frame.instanceBufferIndex;
+			pushConstants.drawBufferIndex     = frame.drawBufferIndex;
+			pushConstants.lodBufferIndex      = lodBufferIndex;
+
+			cullPipeline->bind(commandBuffer);
+			bindless.Bind(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout);
+			vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			vkCmdDispatch(commandBuffer, (frame.instanceCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+		}
+
+		VkMemoryBarrier drawBarrier{};
+		drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		drawBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		drawBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void GpuScene::RecordDraw(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkPipelineLayout pipelineLayout) {
+		if(imageIndex >= frames.size()) return;
+		const auto& frame = frames[imageIndex];
+
+		const VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+		// Model and tint come from the instance buffer, firstInstance of
+		// each draw is its slot.
+		const MeshPushConstants pushConstants{ glm::mat4(1.0f), glm::vec4(1.0f), frame.instanceBufferIndex };
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstants), &pushConstants);
+
+		vkCmdDrawIndexedIndirectCount(commandBuffer,
+			frame.drawBuffer, GPU_BUFFER_HEADER_SIZE,
+			frame.drawBuffer, 0,
+			capacity, sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "VkDevice.hpp"
+#include "VkBindless.hpp"
+#include "VkPipeline.hpp"
+#include "AssetLoader.hpp"
+#include "GameEntity.hpp"
+#include "VertexFormat.hpp"
+
+#include <vector>
+
+namespace Paddle {
+	// Instances per swapchain image, further clamped to maxDrawIndirectCount.
+	static constexpr uint32_t GPU_SCENE_MAX_INSTANCES = 8192;
+
+	// GPU-driven drawing of every instance of one mesh. The simulation only
+	// fills an instance list; a compute pass culls it against the frustum,
+	// picks each LOD and writes VkDrawIndexedIndirectCommands plus their
+	// count, and one vkCmdDrawIndexedIndirectCount draws them all. The CPU
+	// side costs the same no matter how many instances there are, and the
+	// recorded draw never has to change.
+	//
+	// Every buffer is per swapchain image and reached by shaders through
+	// the bindless set. Render thread only.
+	class GpuScene {
+	public:
+		GpuScene(Vk::Device& device, Vk::BindlessDescriptors& bindless, AssetLoader& assets, const MeshData& mesh, VertexFormat vertexFormat);
+		~GpuScene();
+
+		GpuScene(const GpuScene&) = delete;
+		GpuScene& operator=(const GpuScene&) = delete;
+
+		// Queues the culling shader read.
+		static void Prefetch(AssetLoader& assets);
+
+		// Creates buffers for images it hasn't seen yet. Writes the bindless
+		// set, so only with nothing recorded that binds it (startup or
+		// swapchain recreation).
+		void Resize(size_t imageCount);
+
+		// After the image's previous submission retired.
+		void UploadInstances(uint32_t imageIndex, const std::vector<GpuInstance>& instances);
+
+		// Outside the render pass: resets the draw count, culls and writes
+		// the indirect draws the image's draw will read.
+		void RecordCulling(VkCommandBuffer commandBuffer, uint32_t imageIndex, const DrawView& view);
+
+		// Inside the render pass with the GPU-driven mesh pipeline bound.
+		void RecordDraw(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkPipelineLayout pipelineLayout);
+
+	private:
+		struct FrameResources {
+			VkBuffer instanceBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+			void* instancesMapped = nullptr;
+			uint32_t instanceBufferIndex = 0;
+			uint32_t instanceCount = 0;
+
+			// Draw count, then the indirect commands. Written by the GPU only.
+			VkBuffer drawBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory drawMemory = VK_NULL_HANDLE;
+			uint32_t drawBufferIndex = 0;
+		};
+
+		void CreateGeometry(const MeshData& mesh, VertexFormat vertexFormat);
+		void CreateLodBuffer(const MeshData& mesh);
+		void CreateCullPipeline(AssetLoader& assets);
+		void DestroyBuffer(VkBuffer& buffer, VkDeviceMemory& memory);
+
+		Vk::Device& device;
+		Vk::BindlessDescriptors& bindless;
+		uint32_t capacity;
+		bool reportedOverflow = false;
+
+		// Shared by every instance
+		VkBuffer vertexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+		VkBuffer lodBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory lodMemory = VK_NULL_HANDLE;
+		uint32_t lodBufferIndex = 0;
+
+		VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+		Vk::ComputePipeline* cullPipeline = nullptr;
+
+		std::vector<FrameResources> frames;
+	};
+}
@@ -0,0 +1,185 @@
+#include "JobSystem.hpp"
+#include "Utils.hpp"
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <string>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	static thread_local uint32_t currentWorkerIndex = 0;
+
+	JobSystem::JobSystem(uint32_t workerCount) {
+		if(workerCount == 0) {
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		// Slot 0 belongs to the main thread, workers own the rest.
+		for(uint32_t i = 0; i <= workerCount; ++i)
+			queues.push_back(new WorkerQueue());
+
+		for(uint32_t i = 1; i <= workerCount; ++i)
+			threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+
+		DebugLog("Job system started with " + std::to_string(workerCount) + " workers.");
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			running = false;
+		}
+		wakeCondition.notify_all();
+
+		for(auto& thread : threads) thread.join();
+		Utils::DestroyPtrs<WorkerQueue>(queues);
+	}
+
+	uint32_t JobSystem::CurrentWorkerIndex() {
+		return currentWorkerIndex;
+	}
+
+	void JobSystem::Submit(JobFunction function, JobCounter* counter) {
+		if(counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+		Push(Job{ std::move(function), counter });
+	}
+
+	void JobSystem::SubmitAfter(JobCounter& dependency, JobFunction function, JobCounter* counter) {
+		if(counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+
+		Job job{ std::move(function), counter };
+		{
+			std::lock_guard<std::mutex> lock(dependency.waitersMutex);
+			if(!dependency.IsDone()) {
+				dependency.waiters.push_back(std::move(job));
+				return;
+			}
+		}
+
+		Push(std::move(job));
+	}
+
+	void JobSystem::Wait(JobCounter& counter) {
+		const uint32_t workerIndex = currentWorkerIndex;
+
+		while(!counter.IsDone()) {
+			Job job;
+			if(PopOrSteal(workerIndex, job)) Execute(job);
+			else std::this_thread::yield();
+		}
+
+		// The last Finish() may still hold the waiters lock; don't let the
+		// caller destroy the counter underneath it.
+		std::lock_guard<std::mutex> lock(counter.waitersMutex);
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const ParallelForFunction& function) {
+		if(count == 0) return;
+		grainSize = std::max(grainSize, 1u);
+
+		// Not worth waking anybody up for a single chunk.
+		if(count <= grainSize) {
+			function(0, count);
+			return;
+		}
+
+		JobCounter counter;
+		for(uint32_t begin = 0; begin < count; begin += grainSize) {
+			const uint32_t end = std::min(begin + grainSize, count);
+			Submit([&function, begin, end]() { function(begin, end); }, &counter);
+		}
+
+		Wait(counter);
+	}
+
+	void JobSystem::WorkerLoop(uint32_t workerIndex) {
+		currentWorkerIndex = workerIndex;
+		PROFILE_THREAD("Worker " + std::to_string(workerIndex));
+
+		while(running) {
+			Job job;
+			if(PopOrSteal(workerIndex, job)) {
+				Execute(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.wait(lock, [this]() {
+				return pendingJobs.load() > 0 || !running;
+			});
+		}
+	}
+
+	void JobSystem::Push(Job job) {
+		auto* queue = queues[currentWorkerIndex];
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->jobs.push_back(std::move(job));
+		}
+
+		pendingJobs.fetch_add(1);
+		{
+			// Taking the lock here closes the gap between a worker checking
+			// pendingJobs and going to sleep, so the notify can't get lost.
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wakeCondition.notify_one();
+	}
+
+	bool JobSystem::PopOrSteal(uint32_t workerIndex, Job& job) {
+		//
+		// Own queue first, newest job (LIFO) keeps the cache warm
+		//
+		{
+			auto* queue = queues[workerIndex];
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			if(!queue->jobs.empty()) {
+				job = std::move(queue->jobs.back());
+				queue->jobs.pop_back();
+				pendingJobs.fetch_sub(1);
+				return true;
+			}
+		}
+
+		//
+		// Steal the oldest job from somebody else
+		//
+		const size_t queueCount = queues.size();
+		for(size_t i = 1; i < queueCount; ++i) {
+			auto* victim = queues[(workerIndex + i) % queueCount];
+			std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+			if(!lock.owns_lock() || victim->jobs.empty()) continue;
+
+			job = std::move(victim->jobs.front());
+			victim->jobs.pop_front();
+			pendingJobs.fetch_sub(1);
+			return true;
+		}
+
+		return false;
+	}
+
+	void JobSystem::Execute(Job& job) {
+		PROFILE_SCOPE("Job");
+		job.function();
+		Finish(job.counter);
+	}
+
+	void JobSystem::Finish(JobCounter* counter) {
+		if(!counter) return;
+
+		//
+		// Counter drained, release everything that was waiting on it
+		//
+		std::vector<Job> released;
+		{
+			std::lock_guard<std::mutex> lock(counter->waitersMutex);
+			if(counter->value.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+			released.swap(counter->waiters);
+		}
+
+		for(auto& job : released) Push(std::move(job));
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Paddle {
+	using JobFunction = std::function<void()>;
+	using ParallelForFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+	struct JobCounter;
+
+	struct Job {
+		JobFunction function;
+		JobCounter* counter = nullptr;
+	};
+
+	// Tracks a group of in-flight jobs. Every job submitted against a counter
+	// increments it and decrements it once finished; jobs submitted with
+	// SubmitAfter() are held back until the dependency counter drains to zero.
+	struct JobCounter {
+		std::atomic<int> value{ 0 };
+
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::mutex waitersMutex;
+		std::vector<Job> waiters;
+	};
+
+	class JobSystem {
+	public:
+		// workerCount of 0 picks one worker per hardware thread, minus the main thread.
+		explicit JobSystem(uint32_t workerCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void Submit(JobFunction function, JobCounter* counter = nullptr);
+		void SubmitAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+
+		// Blocks until the counter reaches zero. The calling thread executes
+		// queued jobs while it waits instead of sleeping.
+		void Wait(JobCounter& counter);
+
+		// Splits [0, count) into chunks of grainSize and runs them across all
+		// workers. Returns once every chunk has finished.
+		void ParallelFor(uint32_t count, uint32_t grainSize, const ParallelForFunction& function);
+
+		uint32_t GetWorkerCount() const { return static_cast<uint32_t>(threads.size()); }
+
+		// 0 for the main thread (and any thread not owned by the job system),
+		// 1..N for workers.
+		static uint32_t CurrentWorkerIndex();
+
+	private:
+		struct WorkerQueue {
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		void WorkerLoop(uint32_t workerIndex);
+		void Push(Job job);
+		bool PopOrSteal(uint32_t workerIndex, Job& job);
+		void Execute(Job& job);
+		void Finish(JobCounter* counter);
+
+		std::vector<std::thread> threads;
+		std::vector<WorkerQueue*> queues;
+
+		std::atomic<bool> running{ true };
+		std::atomic<int> pendingJobs{ 0 };
+		std::mutex wakeMutex;
+		std::condition_variable wakeCondition;
+	};
+}
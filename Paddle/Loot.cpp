@@ -16,15 +16,15 @@ namespace Paddle {
 		: GameEntity(context)  {
 		verticesInstance = {
 			// Front face
-			{{-0.15f, -0.15f,  0.15f}, {0,0,0}, {0,0,1}, {0,0}},
-			{{ 0.15f, -0.15f,  0.15f}, {0,0,0}, {0,0,1}, {1,0}},
-			{{ 0.15f,  0.15f,  0.15f}, {0,0,0}, {0,0,1}, {1,1}},
-			{{-0.15f,  0.15f,  0.15f}, {0,0,0}, {0,0,1}, {0,1}},
+			{{-0.15f, -0.15f,  0.15f}, {0,0,1}, {0,0}},
+			{{ 0.15f, -0.15f,  0.15f}, {0,0,1}, {1,0}},
+			{{ 0.15f,  0.15f,  0.15f}, {0,0,1}, {1,1}},
+			{{-0.15f,  0.15f,  0.15f}, {0,0,1}, {0,1}},
 			// Back face
-			{{-0.15f, -0.15f, -0.15f}, {0,0,0}, {0,0,-1}, {1,0}},
-			{{ 0.15f, -0.15f, -0.15f}, {0,0,0}, {0,0,-1}, {0,0}},
-			{{ 0.15f,  0.15f, -0.15f}, {0,0,0}, {0,0,-1}, {0,1}},
-			{{-0.15f,  0.15f, -0.15f}, {0,0,0}, {0,0,-1}, {1,1}},
+			{{-0.15f, -0.15f, -0.15f}, {0,0,-1}, {1,0}},
+			{{ 0.15f, -0.15f, -0.15f}, {0,0,-1}, {0,0}},
+			{{ 0.15f,  0.15f, -0.15f}, {0,0,-1}, {0,1}},
+			{{-0.15f,  0.15f, -0.15f}, {0,0,-1}, {1,1}},
 		};
 		indicesInstance = {
 			0, 1, 2, 2, 3, 0,  // Front face
@@ -44,7 +44,7 @@ namespace Paddle {
                 }
                 isLifeLoot = !isBulletLoot;
 
-		for(auto& v : verticesInstance) v.color = applyColor;
+		tintColor = glm::vec4(applyColor, 1.0f);
 
 		velocity = glm::vec3(0.25f, 0.0f, 0.0f);
 		SetPosition(glm::vec3(x, y, z));
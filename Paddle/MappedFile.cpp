@@ -0,0 +1,93 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Paddle {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(!mapped) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		fileHandle = file;
+		mappingHandle = mapping;
+		view = mapped;
+		size = static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if(view) UnmapViewOfFile(view);
+		if(mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+		if(fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+
+		view = nullptr;
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+		size = 0;
+	}
+#else
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+
+		const int file = open(path.c_str(), O_RDONLY);
+		if(file < 0) return false;
+
+		struct stat fileStat;
+		if(fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+			close(file);
+			return false;
+		}
+
+		// The mapping keeps its own reference, the descriptor isn't needed anymore.
+		void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if(mapped == MAP_FAILED) return false;
+
+		view = mapped;
+		size = static_cast<size_t>(fileStat.st_size);
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if(view) munmap(view, size);
+
+		view = nullptr;
+		size = 0;
+	}
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Paddle {
+	// Read-only memory mapping of a whole file. The pages are faulted in by
+	// the OS on first touch, so opening is cheap no matter how big the file is.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Returns false (and stays closed) if the file is missing or empty.
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return view != nullptr; }
+		const unsigned char* Data() const { return static_cast<const unsigned char*>(view); }
+		size_t Size() const { return size; }
+
+	private:
+		void* view = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,280 @@
+#include "MeshFile.hpp"
+#include "Utils.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "Vendor\tiny_obj_loader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	static constexpr uint32_t MESH_FILE_MAX_ATTRIBUTES = 4;
+
+	struct MeshFileAttribute {
+		uint32_t location;
+		uint32_t format; // VkFormat
+		uint32_t offset;
+	};
+
+	struct MeshFileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t vertexFormat;
+		uint32_t vertexStride;
+		uint32_t attributeCount;
+		MeshFileAttribute attributes[MESH_FILE_MAX_ATTRIBUTES];
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t lodCount;
+		float boundingRadius;
+		uint32_t reserved;
+		uint64_t lodOffset;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t sourceHash; // Utils::HashBytes of the OBJ
+	};
+
+	struct MeshFileLod {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float maxPixelSize;
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(MeshFileHeader) == 120, "MeshFileHeader layout is part of the file format");
+	static_assert(sizeof(MeshFileLod) == 16, "MeshFileLod layout is part of the file format");
+
+	static const char MESH_FILE_MAGIC[4] = { 'P', 'M', 'S', 'H' };
+
+	static uint64_t AlignOffset(uint64_t offset) {
+		return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+	}
+
+	//
+	// Loading
+	//
+
+	static bool LayoutMatches(const MeshFileHeader& header) {
+		if(header.vertexFormat >= VERTEX_FORMAT_COUNT) return false;
+
+		const VertexFormat format = static_cast<VertexFormat>(header.vertexFormat);
+		if(header.vertexStride != GetVertexStride(format)) return false;
+
+		const auto attributes = GetVertexAttributeDescriptions(format);
+		if(header.attributeCount != attributes.size()) return false;
+
+		for(size_t i = 0; i < attributes.size(); ++i) {
+			const MeshFileAttribute& stored = header.attributes[i];
+			if(stored.location != attributes[i].location ||
+				stored.format != static_cast<uint32_t>(attributes[i].format) ||
+				stored.offset != attributes[i].offset) return false;
+		}
+		return true;
+	}
+
+	bool OpenMeshFile(const AssetFileSystem& files, const std::string& path, MeshData& mesh) {
+		if(!files.Open(path, mesh.file)) return false;
+
+		const unsigned char* data = mesh.file.Data();
+		const uint64_t size = mesh.file.Size();
+
+		MeshFileHeader header;
+		if(size < sizeof(header)) {
+			mesh.file.Close();
+			return false;
+		}
+		memcpy(&header, data, sizeof(header));
+
+		const bool valid =
+			memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+			header.version == MESH_FILE_VERSION &&
+			LayoutMatches(header) &&
+			header.lodCount > 0 &&
+			header.vertexOffset % MESH_FILE_ALIGNMENT == 0 &&
+			header.indexOffset % MESH_FILE_ALIGNMENT == 0 &&
+			header.lodOffset + static_cast<uint64_t>(header.lodCount) * sizeof(MeshFileLod) <= size &&
+			header.vertexOffset + static_cast<uint64_t>(header.vertexCount) * header.vertexStride <= size &&
+			header.indexOffset + static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t) <= size;
+
+		if(!valid) {
+			DebugLog("Mesh file is stale or corrupt: " + path);
+			mesh.file.Close();
+			return false;
+		}
+
+		mesh.lods.resize(header.lodCount);
+		for(uint32_t level = 0; level < header.lodCount; ++level) {
+			MeshFileLod stored;
+			memcpy(&stored, data + header.lodOffset + level * sizeof(MeshFileLod), sizeof(stored));
+
+			if(static_cast<uint64_t>(stored.firstIndex) + stored.indexCount > header.indexCount) {
+				DebugLog("Mesh file has a LOD outside its index blob: " + path);
+				mesh.lods.clear();
+				mesh.file.Close();
+				return false;
+			}
+			mesh.lods[level] = MeshLod{ stored.firstIndex, stored.indexCount, stored.maxPixelSize };
+		}
+
+		mesh.vertexFormat = static_cast<VertexFormat>(header.vertexFormat);
+		mesh.vertexCount = header.vertexCount;
+		mesh.indexCount = header.indexCount;
+		mesh.boundingRadius = header.boundingRadius;
+		mesh.sourceHash = header.sourceHash;
+
+		// Mappings are page aligned, pack entries 16 byte aligned and the
+		// blobs sit on 16 byte boundaries, so both can be read (and uploaded)
+		// in place.
+		mesh.vertexData = data + header.vertexOffset;
+		mesh.indexData = reinterpret_cast<const uint32_t*>(data + header.indexOffset);
+		return true;
+	}
+
+	//
+	// Conversion
+	//
+
+	bool HashMeshSource(const std::string& objPath, uint64_t& hash) {
+		MappedFile source;
+		if(!source.Open(objPath)) return false;
+		hash = Utils::HashBytes(source.Data(), source.Size());
+		return true;
+	}
+
+	static void ImportObj(const std::string& path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials; // Not used for now
+		std::string warn, err;
+
+		bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), nullptr, true);
+		if(!warn.empty()) DebugLog("Tinyobj warning: " + warn);
+		if(!err.empty())  DebugLog("Tinyobj error: " + err);
+
+		if(!ret) throw std::runtime_error("Failed to load OBJ file: " + path);
+
+		std::unordered_map<Vertex, uint32_t, VertexHasher> uniqueVertices{};
+
+		for(const auto& shape : shapes) {
+			for(const auto& index : shape.mesh.indices) {
+				Vertex vertex{};
+
+				// Position
+				if(index.vertex_index >= 0) {
+					vertex.pos = {
+							attrib.vertices[3 * index.vertex_index + 0],
+							attrib.vertices[3 * index.vertex_index + 1],
+							attrib.vertices[3 * index.vertex_index + 2]
+					};
+				}
+
+				// Normal
+				if(index.normal_index >= 0) {
+					vertex.normal = {
+							attrib.normals[3 * index.normal_index + 0],
+							attrib.normals[3 * index.normal_index + 1],
+							attrib.normals[3 * index.normal_index + 2]
+					};
+				}
+				else vertex.normal = glm::vec3(0.0f);
+
+				// Texture Coordinates (UV)
+				if(index.texcoord_index >= 0) {
+					vertex.uv = {
+							attrib.texcoords[2 * index.texcoord_index + 0],
+							1.0f - attrib.texcoords[2 * index.texcoord_index + 1] // Flip V
+					};
+				}
+				else vertex.uv = glm::vec2(0.0f);
+
+				// De-duplicate
+				if(uniqueVertices.count(vertex) == 0) {
+					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+					vertices.push_back(vertex);
+				}
+
+				indices.push_back(uniqueVertices[vertex]);
+			}
+		}
+	}
+
+	static void WritePadding(std::ofstream& file, uint64_t offset) {
+		static const char zeros[MESH_FILE_ALIGNMENT] = {};
+		const uint64_t written = static_cast<uint64_t>(file.tellp());
+		if(offset > written) file.write(zeros, static_cast<std::streamsize>(offset - written));
+	}
+
+	void ConvertObjToMeshFile(const std::string& objPath, const std::string& meshPath, VertexFormat format) {
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		ImportObj(objPath, vertices, indices);
+
+		OptimizeMesh(objPath, vertices, indices);
+		const std::vector<MeshLod> lods = BuildLodChain(vertices, indices);
+		const std::vector<uint8_t> packed = PackVertices(format, vertices);
+
+		MeshFileHeader header{};
+		memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+		header.version = MESH_FILE_VERSION;
+		header.vertexFormat = format;
+		header.vertexStride = GetVertexStride(format);
+
+		const auto attributes = GetVertexAttributeDescriptions(format);
+		header.attributeCount = static_cast<uint32_t>(attributes.size());
+		for(size_t i = 0; i < attributes.size() && i < MESH_FILE_MAX_ATTRIBUTES; ++i) {
+			header.attributes[i] = MeshFileAttribute{ attributes[i].location, static_cast<uint32_t>(attributes[i].format), attributes[i].offset };
+		}
+
+		header.vertexCount = static_cast<uint32_t>(vertices.size());
+		header.indexCount = static_cast<uint32_t>(indices.size());
+		header.lodCount = static_cast<uint32_t>(lods.size());
+		for(const auto& v : vertices) header.boundingRadius = std::max(header.boundingRadius, glm::length(v.pos));
+		HashMeshSource(objPath, header.sourceHash);
+
+		header.lodOffset = sizeof(header);
+		header.vertexOffset = AlignOffset(header.lodOffset + lods.size() * sizeof(MeshFileLod));
+		header.indexOffset = AlignOffset(header.vertexOffset + packed.size());
+
+		const bool written = Utils::WriteFileAtomically(meshPath, [&](std::ofstream& file) {
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			for(const auto& lod : lods) {
+				const MeshFileLod stored{ lod.firstIndex, lod.indexCount, lod.maxPixelSize, 0 };
+				file.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+			}
+			WritePadding(file, header.vertexOffset);
+			file.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+			WritePadding(file, header.indexOffset);
+			file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+		});
+
+		if(!written) throw std::runtime_error("Failed to write mesh file: " + meshPath);
+	}
+
+	int RunMeshConverter(const std::string& objPath, const std::string& meshPath) {
+		try {
+			ConvertObjToMeshFile(objPath, meshPath);
+
+			AssetFileSystem looseFiles;
+			MeshData mesh;
+			if(!OpenMeshFile(looseFiles, meshPath, mesh)) throw std::runtime_error("Failed to read back mesh file: " + meshPath);
+
+			printf("%s -> %s: %u vertices (%s), %u indices, %zu LODs, %zu bytes\n",
+				objPath.c_str(), meshPath.c_str(), mesh.vertexCount, GetVertexFormatName(mesh.vertexFormat),
+				mesh.indexCount, mesh.lods.size(), mesh.file.Size());
+		}
+		catch (const std::exception& e) {
+			fprintf(stderr, "Mesh conversion failed: %s\n", e.what());
+			return EXIT_FAILURE;
+		}
+
+		return EXIT_SUCCESS;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AssetPack.hpp"
+#include "MeshOptimizer.hpp"
+#include "VertexFormat.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Paddle {
+	// Mesh ready for upload: vertices already in a GPU vertex format, every
+	// LOD's indices back to back. The blobs point straight into the opened
+	// .pmesh file, nothing is parsed or copied at load time. Positions and
+	// normals are in model space, entities apply scale and rotation through
+	// their model matrix.
+	struct MeshData {
+		VertexFormat vertexFormat = VERTEX_FORMAT_PACKED;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		const uint8_t* vertexData = nullptr;  // vertexCount * GetVertexStride(vertexFormat)
+		const uint32_t* indexData = nullptr;
+		std::vector<MeshLod> lods;
+		float boundingRadius = 0.0f; // Around the model origin
+		uint64_t sourceHash = 0;     // Of the OBJ it was converted from
+
+		AssetFile file;
+	};
+
+	// .pmesh layout, all little endian:
+	//   MeshFileHeader
+	//   MeshFileLod[lodCount]
+	//   vertex blob, MESH_FILE_ALIGNMENT aligned
+	//   uint32_t index blob, MESH_FILE_ALIGNMENT aligned
+	// The header carries the vertex layout it was written with, so files
+	// from an older VertexFormat table are rejected instead of misread.
+	// Bump the version whenever the layout or OptimizeMesh() output changes.
+	static constexpr uint32_t MESH_FILE_VERSION = 2;
+	static constexpr uint32_t MESH_FILE_ALIGNMENT = 16;
+
+	// Opens a .pmesh file through the asset file system. Returns false (and
+	// leaves the mesh empty) if it is missing, truncated or from an older
+	// version.
+	bool OpenMeshFile(const AssetFileSystem& files, const std::string& path, MeshData& mesh);
+
+	// Hashes the OBJ a .pmesh is converted from, to compare against
+	// MeshData::sourceHash. Returns false if the OBJ is not on disk (shipped
+	// builds only have the pack).
+	bool HashMeshSource(const std::string& objPath, uint64_t& hash);
+
+	// Imports an OBJ, optimizes it, builds its LOD chain and writes the
+	// result as a .pmesh in the given vertex format.
+	void ConvertObjToMeshFile(const std::string& objPath, const std::string& meshPath, VertexFormat format = VERTEX_FORMAT_PACKED);
+
+	// Offline entry point for --convert-mesh. Returns a process exit code.
+	int RunMeshConverter(const std::string& objPath, const std::string& meshPath);
+}
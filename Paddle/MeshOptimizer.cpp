@@ -0,0 +1,349 @@
+#include "MeshOptimizer.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	//
+	// Metrics
+	//
+
+	float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+		if(indices.size() < 3) return 0.0f;
+
+		// Timestamps instead of a real queue: a vertex is still cached if
+		// fewer than cacheSize misses happened since it went in.
+		std::vector<uint32_t> cachedAt(vertexCount, 0);
+		uint32_t misses = 0;
+		for(uint32_t index : indices) {
+			if(cachedAt[index] == 0 || misses - cachedAt[index] >= cacheSize) {
+				++misses;
+				cachedAt[index] = misses;
+			}
+		}
+
+		return static_cast<float>(misses) / (indices.size() / 3);
+	}
+
+	//
+	// Vertex cache
+	//
+
+	static constexpr int FORSYTH_CACHE_SIZE = 32;
+
+	static float ForsythVertexScore(int cachePosition, uint32_t activeTriangles) {
+		static constexpr float CACHE_DECAY_POWER = 1.5f;
+		static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		if(activeTriangles == 0) return -1.0f;
+
+		float score = 0.0f;
+		if(cachePosition >= 0) {
+			// The last triangle's vertices get a fixed score so the next one
+			// doesn't just reuse the same edge forever.
+			if(cachePosition < 3) score = LAST_TRIANGLE_SCORE;
+			else {
+				const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+
+		// Finish off vertices with few triangles left, they'd be lonely otherwise.
+		score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(activeTriangles), -VALENCE_BOOST_POWER);
+		return score;
+	}
+
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+		const size_t triangleCount = indices.size() / 3;
+		if(triangleCount == 0) return;
+
+		//
+		// Vertex to triangle adjacency, CSR style
+		//
+		std::vector<uint32_t> activeTriangles(vertexCount, 0);
+		for(uint32_t index : indices) ++activeTriangles[index];
+
+		std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+		for(size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] = adjacencyStart[v] + activeTriangles[v];
+
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for(size_t t = 0; t < triangleCount; ++t) {
+				for(int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+			}
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for(size_t v = 0; v < vertexCount; ++v) vertexScore[v] = ForsythVertexScore(-1, activeTriangles[v]);
+
+		std::vector<float> triangleScore(triangleCount);
+		for(size_t t = 0; t < triangleCount; ++t) {
+			triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		// Room for the whole cache plus the three vertices pushed in front.
+		std::vector<uint32_t> cache, nextCache;
+		cache.reserve(FORSYTH_CACHE_SIZE + 3);
+		nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+		size_t bestTriangle = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+		size_t scanCursor = 0;
+
+		for(size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+			//
+			// Nothing adjacent to the cache is left, take the next unused one
+			//
+			if(bestTriangle == SIZE_MAX) {
+				while(emitted[scanCursor]) ++scanCursor;
+				bestTriangle = scanCursor;
+			}
+
+			const uint32_t* triangle = &indices[bestTriangle * 3];
+			emitted[bestTriangle] = true;
+			result.insert(result.end(), triangle, triangle + 3);
+
+			//
+			// Detach the triangle from its vertices and push them to the
+			// front of the cache
+			//
+			nextCache.clear();
+			for(int k = 0; k < 3; ++k) {
+				const uint32_t v = triangle[k];
+				uint32_t* begin = &adjacency[adjacencyStart[v]];
+				uint32_t* end = begin + activeTriangles[v];
+				std::iter_swap(std::find(begin, end, static_cast<uint32_t>(bestTriangle)), end - 1);
+				--activeTriangles[v];
+				nextCache.push_back(v);
+			}
+			for(uint32_t v : cache) {
+				if(v != triangle[0] && v != triangle[1] && v != triangle[2]) nextCache.push_back(v);
+			}
+
+			for(size_t i = 0; i < nextCache.size(); ++i) {
+				const uint32_t v = nextCache[i];
+				const int position = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+				cachePosition[v] = position;
+
+				// Rescore everything touching a vertex whose score moved.
+				const float newScore = ForsythVertexScore(position, activeTriangles[v]);
+				const float delta = newScore - vertexScore[v];
+				vertexScore[v] = newScore;
+				for(uint32_t a = 0; a < activeTriangles[v]; ++a) triangleScore[adjacency[adjacencyStart[v] + a]] += delta;
+			}
+			if(nextCache.size() > FORSYTH_CACHE_SIZE) nextCache.resize(FORSYTH_CACHE_SIZE);
+			cache.swap(nextCache);
+
+			//
+			// Best next triangle among the ones touching the cache
+			//
+			bestTriangle = SIZE_MAX;
+			float bestScore = -1.0f;
+			for(uint32_t v : cache) {
+				for(uint32_t a = 0; a < activeTriangles[v]; ++a) {
+					const uint32_t t = adjacency[adjacencyStart[v] + a];
+					if(triangleScore[t] > bestScore) {
+						bestScore = triangleScore[t];
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+
+		indices.swap(result);
+	}
+
+	//
+	// Vertex fetch
+	//
+
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		static constexpr uint32_t UNUSED = UINT32_MAX;
+
+		std::vector<uint32_t> remap(vertices.size(), UNUSED);
+		std::vector<Vertex> reordered;
+		reordered.reserve(vertices.size());
+
+		for(auto& index : indices) {
+			if(remap[index] == UNUSED) {
+				remap[index] = static_cast<uint32_t>(reordered.size());
+				reordered.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+
+		vertices.swap(reordered);
+	}
+
+	//
+	// Simplification
+	//
+
+	static std::vector<uint32_t> ClusterVertices(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+		const glm::vec3& boundsMin, float cellSize) {
+		//
+		// One representative per (cell, normal octant): the member closest
+		// to the cell's average position
+		//
+		std::unordered_map<uint64_t, uint32_t> clusterIds;
+		std::vector<uint32_t> vertexCluster(vertices.size());
+		std::vector<glm::vec3> clusterSum;
+		std::vector<uint32_t> clusterCount;
+
+		for(size_t v = 0; v < vertices.size(); ++v) {
+			const glm::vec3 cell = glm::floor((vertices[v].pos - boundsMin) / cellSize);
+			const uint64_t octant = (vertices[v].normal.x < 0.0f ? 1 : 0) | (vertices[v].normal.y < 0.0f ? 2 : 0) | (vertices[v].normal.z < 0.0f ? 4 : 0);
+			const uint64_t key = (static_cast<uint64_t>(cell.x) << 43) | (static_cast<uint64_t>(cell.y) << 23) | (static_cast<uint64_t>(cell.z) << 3) | octant;
+
+			auto it = clusterIds.find(key);
+			if(it == clusterIds.end()) {
+				it = clusterIds.emplace(key, static_cast<uint32_t>(clusterSum.size())).first;
+				clusterSum.push_back(glm::vec3(0.0f));
+				clusterCount.push_back(0);
+			}
+			vertexCluster[v] = it->second;
+			clusterSum[it->second] += vertices[v].pos;
+			++clusterCount[it->second];
+		}
+
+		std::vector<uint32_t> representative(clusterSum.size(), UINT32_MAX);
+		std::vector<float> bestDistance(clusterSum.size(), 0.0f);
+		for(size_t v = 0; v < vertices.size(); ++v) {
+			const uint32_t c = vertexCluster[v];
+			const glm::vec3 offset = vertices[v].pos - clusterSum[c] / static_cast<float>(clusterCount[c]);
+			const float distance = glm::dot(offset, offset);
+			if(representative[c] == UINT32_MAX || distance < bestDistance[c]) {
+				representative[c] = static_cast<uint32_t>(v);
+				bestDistance[c] = distance;
+			}
+		}
+
+		//
+		// Remap, dropping collapsed and repeated triangles
+		//
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		std::unordered_map<uint64_t, bool> seen;
+		for(size_t t = 0; t + 2 < indices.size(); t += 3) {
+			uint32_t a = representative[vertexCluster[indices[t]]];
+			uint32_t b = representative[vertexCluster[indices[t + 1]]];
+			uint32_t c = representative[vertexCluster[indices[t + 2]]];
+			if(a == b || b == c || a == c) continue;
+
+			// Same triangle in any rotation hashes the same, winding is kept.
+			uint32_t rotated[3] = { a, b, c };
+			std::rotate(rotated, std::min_element(rotated, rotated + 3), rotated + 3);
+			const uint64_t key = (static_cast<uint64_t>(rotated[0]) << 42) ^ (static_cast<uint64_t>(rotated[1]) << 21) ^ rotated[2];
+			if(!seen.emplace(key, true).second) continue;
+
+			result.push_back(a);
+			result.push_back(b);
+			result.push_back(c);
+		}
+		return result;
+	}
+
+	std::vector<uint32_t> SimplifyMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount) {
+		if(indices.size() <= targetIndexCount || vertices.empty()) return indices;
+
+		glm::vec3 boundsMin = vertices[0].pos, boundsMax = vertices[0].pos;
+		for(const auto& vertex : vertices) {
+			boundsMin = glm::min(boundsMin, vertex.pos);
+			boundsMax = glm::max(boundsMax, vertex.pos);
+		}
+		const glm::vec3 extent = boundsMax - boundsMin;
+		const float largestExtent = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+
+		//
+		// Binary search the finest grid that still meets the target
+		//
+		static constexpr int MAX_GRID_RESOLUTION = 1024;
+		int low = 1, high = MAX_GRID_RESOLUTION;
+		std::vector<uint32_t> best = ClusterVertices(vertices, indices, boundsMin, largestExtent * 1.001f);
+		while(low < high) {
+			const int resolution = (low + high + 1) / 2;
+			std::vector<uint32_t> candidate = ClusterVertices(vertices, indices, boundsMin, largestExtent / resolution);
+			if(candidate.size() <= targetIndexCount) {
+				best.swap(candidate);
+				low = resolution;
+			}
+			else high = resolution - 1;
+		}
+		return best;
+	}
+
+	//
+	// Level of detail
+	//
+
+	// Triangle budget of each level and the largest on-screen diameter (in
+	// pixels) it's still used for. Levels that don't save much get skipped.
+	struct LodLevel {
+		float triangleRatio;
+		float maxPixelSize;
+	};
+
+	static const LodLevel LOD_LEVELS[] = {
+		{ 1.0f,  FLT_MAX },
+		{ 0.35f, 120.0f  },
+		{ 0.12f, 50.0f   },
+		{ 0.04f, 20.0f   },
+	};
+
+	std::vector<MeshLod> BuildLodChain(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		const std::vector<uint32_t> fullIndices = indices;
+		std::vector<MeshLod> lods(1, MeshLod{ 0, static_cast<uint32_t>(fullIndices.size()), FLT_MAX });
+
+		for(size_t level = 1; level < sizeof(LOD_LEVELS) / sizeof(LOD_LEVELS[0]); ++level) {
+			const size_t targetIndexCount = static_cast<size_t>(fullIndices.size() / 3 * LOD_LEVELS[level].triangleRatio) * 3;
+			std::vector<uint32_t> lodIndices = SimplifyMesh(vertices, fullIndices, targetIndexCount);
+			if(lodIndices.empty() || lodIndices.size() * 10 > lods.back().indexCount * 9) continue;
+
+			OptimizeVertexCache(lodIndices, vertices.size());
+			lods.push_back(MeshLod{ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodIndices.size()), LOD_LEVELS[level].maxPixelSize });
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+		}
+		return lods;
+	}
+
+	//
+	// Import stage
+	//
+
+	MeshOptimizeStats OptimizeMesh(const std::string& name, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+		const MeshOptimizeOptions& options) {
+		MeshOptimizeStats stats;
+		stats.trianglesBefore = indices.size() / 3;
+		stats.acmrBefore = ComputeACMR(indices, vertices.size());
+
+		if(options.simplifyRatio < 1.0f) {
+			const size_t targetIndexCount = static_cast<size_t>(stats.trianglesBefore * options.simplifyRatio) * 3;
+			indices = SimplifyMesh(vertices, indices, targetIndexCount);
+		}
+		if(options.optimizeVertexCache) OptimizeVertexCache(indices, vertices.size());
+		if(options.optimizeVertexFetch) OptimizeVertexFetch(vertices, indices);
+
+		stats.trianglesAfter = indices.size() / 3;
+		stats.acmrAfter = ComputeACMR(indices, vertices.size());
+
+		char message[256];
+		snprintf(message, sizeof(message), "Optimized mesh %s: ACMR %.3f -> %.3f, %zu -> %zu triangles, %zu vertices.",
+			name.c_str(), stats.acmrBefore, stats.acmrAfter, stats.trianglesBefore, stats.trianglesAfter, vertices.size());
+		DebugLog(message);
+
+		return stats;
+	}
+}
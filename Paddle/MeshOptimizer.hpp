@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GameVertex.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Paddle {
+	// Average cache miss ratio: transformed vertices per triangle with a FIFO
+	// post-transform cache of cacheSize entries. 3.0 is the worst case, ~0.5
+	// is about as good as a regular grid gets.
+	float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+	// Reorders triangles so vertices get reused while still in the
+	// post-transform cache (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	// Renumbers vertices in first use order so vertex fetch walks memory
+	// forwards. Vertices no triangle references are dropped.
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Vertex clustering: snaps vertices to a grid and keeps one existing
+	// vertex per cell, so the result indexes the same vertex buffer. Shrinks
+	// the grid until at most targetIndexCount indices are left (or it can't
+	// go any coarser). Hard edges survive because clusters never mix normals
+	// pointing into different octants.
+	std::vector<uint32_t> SimplifyMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount);
+
+	// One level of detail: a range of the mesh's index buffer. Every level
+	// indexes the same vertex buffer.
+	struct MeshLod {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float maxPixelSize; // Used while the projected diameter is at most this
+	};
+
+	// Appends progressively coarser index sets behind the full one and
+	// returns where each level lives, finest first. Levels that barely save
+	// anything are left out, so small meshes keep just the one.
+	std::vector<MeshLod> BuildLodChain(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Import stage every mesh goes through before it reaches a vertex buffer.
+	struct MeshOptimizeOptions {
+		bool optimizeVertexCache = true;
+		bool optimizeVertexFetch = true;
+		float simplifyRatio = 1.0f; // Fraction of the triangles to keep, 1 leaves the mesh alone
+	};
+
+	struct MeshOptimizeStats {
+		float acmrBefore = 0.0f;
+		float acmrAfter = 0.0f;
+		size_t trianglesBefore = 0;
+		size_t trianglesAfter = 0;
+	};
+
+	MeshOptimizeStats OptimizeMesh(const std::string& name, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+		const MeshOptimizeOptions& options = MeshOptimizeOptions());
+}
@@ -0,0 +1,128 @@
+#include "PipelineRegistry.hpp"
+#include "Utils.hpp"
+
+#include <type_traits>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+	PipelineRegistry::PipelineRegistry(Vk::Device& device, AssetLoader& assets)
+		: device(device), assets(assets) { }
+
+	PipelineRegistry::~PipelineRegistry() {
+		Clear();
+	}
+
+	Vk::Pipeline* PipelineRegistry::Get(const std::string& vertFilePath, const std::string& fragFilePath, const Vk::PipelineConfigInfo& configInfo) {
+		const std::string key = MakeKey(vertFilePath, fragFilePath, configInfo);
+
+		auto it = variants.find(key);
+		if(it != variants.end()) return it->second;
+
+		Vk::Pipeline* pipeline = new Vk::Pipeline(
+			device,
+			vertFilePath, assets.GetFile(vertFilePath),
+			fragFilePath, assets.GetFile(fragFilePath),
+			configInfo);
+		variants.emplace(key, pipeline);
+
+		DebugLog("Created pipeline variant " + std::to_string(variants.size()) + " (" + vertFilePath + ", " + fragFilePath + ")");
+		return pipeline;
+	}
+
+	void PipelineRegistry::Clear() {
+		for(auto& variant : variants) delete variant.second;
+		variants.clear();
+	}
+
+	//
+	// Variant key
+	//
+
+	template <typename T>
+	static void AppendKey(std::string& key, const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can go into a pipeline key");
+		key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	static void AppendKey(std::string& key, const std::string& value) {
+		AppendKey(key, static_cast<uint32_t>(value.size()));
+		key.append(value);
+	}
+
+	// The create info structs carry pNext pointers and padding, so only
+	// their fields go in. Everything appended raw is tightly packed.
+	std::string PipelineRegistry::MakeKey(const std::string& vertFilePath, const std::string& fragFilePath, const Vk::PipelineConfigInfo& configInfo) {
+		std::string key;
+		key.reserve(512);
+
+		AppendKey(key, vertFilePath);
+		AppendKey(key, fragFilePath);
+
+		// Vertex format
+		const auto& vertexInput = configInfo.vertexInputInfo;
+		AppendKey(key, vertexInput.vertexBindingDescriptionCount);
+		for(uint32_t i = 0; i < vertexInput.vertexBindingDescriptionCount; ++i)
+			AppendKey(key, vertexInput.pVertexBindingDescriptions[i]);
+		AppendKey(key, vertexInput.vertexAttributeDescriptionCount);
+		for(uint32_t i = 0; i < vertexInput.vertexAttributeDescriptionCount; ++i)
+			AppendKey(key, vertexInput.pVertexAttributeDescriptions[i]);
+
+		// Fixed function state
+		AppendKey(key, configInfo.inputAssemblyInfo.topology);
+		AppendKey(key, configInfo.inputAssemblyInfo.primitiveRestartEnable);
+
+		AppendKey(key, configInfo.viewport);
+		AppendKey(key, configInfo.scissor);
+
+		const auto& rasterization = configInfo.rasterizationInfo;
+		AppendKey(key, rasterization.depthClampEnable);
+		AppendKey(key, rasterization.rasterizerDiscardEnable);
+		AppendKey(key, rasterization.polygonMode);
+		AppendKey(key, rasterization.cullMode);
+		AppendKey(key, rasterization.frontFace);
+		AppendKey(key, rasterization.depthBiasEnable);
+		AppendKey(key, rasterization.depthBiasConstantFactor);
+		AppendKey(key, rasterization.depthBiasClamp);
+		AppendKey(key, rasterization.depthBiasSlopeFactor);
+		AppendKey(key, rasterization.lineWidth);
+
+		const auto& multisample = configInfo.multisampleInfo;
+		AppendKey(key, multisample.rasterizationSamples);
+		AppendKey(key, multisample.sampleShadingEnable);
+		AppendKey(key, multisample.minSampleShading);
+		AppendKey(key, multisample.alphaToCoverageEnable);
+		AppendKey(key, multisample.alphaToOneEnable);
+
+		AppendKey(key, configInfo.colorBlendAttachment);
+		AppendKey(key, configInfo.colorBlendInfo.logicOpEnable);
+		AppendKey(key, configInfo.colorBlendInfo.logicOp);
+		AppendKey(key, configInfo.colorBlendInfo.blendConstants);
+
+		const auto& depthStencil = configInfo.depthStencilInfo;
+		AppendKey(key, depthStencil.depthTestEnable);
+		AppendKey(key, depthStencil.depthWriteEnable);
+		AppendKey(key, depthStencil.depthCompareOp);
+		AppendKey(key, depthStencil.depthBoundsTestEnable);
+		AppendKey(key, depthStencil.stencilTestEnable);
+		AppendKey(key, depthStencil.front);
+		AppendKey(key, depthStencil.back);
+		AppendKey(key, depthStencil.minDepthBounds);
+		AppendKey(key, depthStencil.maxDepthBounds);
+
+		// Where it is used
+		AppendKey(key, configInfo.pipelineLayout);
+		AppendKey(key, configInfo.renderPass);
+		AppendKey(key, configInfo.subpass);
+
+		// Specialization constants, already sorted by id
+		const auto& specialization = configInfo.specialization;
+		AppendKey(key, static_cast<uint32_t>(specialization.Entries().size()));
+		for(size_t i = 0; i < specialization.Entries().size(); ++i) {
+			AppendKey(key, specialization.Entries()[i].constantID);
+			AppendKey(key, specialization.Data()[i]);
+		}
+
+		return key;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "VkDevice.hpp"
+#include "VkPipeline.hpp"
+#include "AssetLoader.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace Paddle {
+	// Owns every graphics pipeline. A variant is identified by its shader
+	// pair and everything in the config that ends up in the pipeline: vertex
+	// layout, fixed function state, viewport, layout, render pass and
+	// specialization constants. Those are serialized into a key and hashed,
+	// so asking for a combination that already exists returns the same
+	// pipeline instead of building a duplicate. Render thread only.
+	class PipelineRegistry {
+	public:
+		PipelineRegistry(Vk::Device& device, AssetLoader& assets);
+		~PipelineRegistry();
+
+		PipelineRegistry(const PipelineRegistry&) = delete;
+		PipelineRegistry& operator=(const PipelineRegistry&) = delete;
+
+		// Builds the variant the first time it is asked for. The pointer
+		// stays valid until Clear().
+		Vk::Pipeline* Get(const std::string& vertFilePath, const std::string& fragFilePath, const Vk::PipelineConfigInfo& configInfo);
+
+		// Destroys every variant. Only with the device idle, e.g. once the
+		// render pass they were built against is gone.
+		void Clear();
+
+		size_t Size() const { return variants.size(); }
+
+	private:
+		static std::string MakeKey(const std::string& vertFilePath, const std::string& fragFilePath, const Vk::PipelineConfigInfo& configInfo);
+
+		Vk::Device& device;
+		AssetLoader& assets;
+
+		// Full key bytes, not just their hash, so a collision can never hand
+		// out the wrong pipeline.
+		std::unordered_map<std::string, Vk::Pipeline*> variants;
+	};
+}
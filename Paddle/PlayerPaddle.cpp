@@ -7,17 +7,18 @@ namespace Paddle {
 	const auto DEFAULT_POSITION = glm::vec3(5.5f, 0.0f, 0.0f);
 
 	PlayerPaddle::PlayerPaddle(GameContext& context) : GameEntity(context)  {
+		tintColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 		verticesInstance = {
 			// Front face
-			{{-0.001f, -0.25f,  0.075f}, {0,0,0}, {0,0,1}, {0,0}},
-			{{ 0.001f, -0.25f,  0.075f}, {0,0,0}, {0,0,1}, {1,0}},
-			{{ 0.001f,  0.25f,  0.075f}, {0,0,0}, {0,0,1}, {1,1}},
-			{{-0.001f,  0.25f,  0.075f}, {0,0,0}, {0,0,1}, {0,1}},
+			{{-0.001f, -0.25f,  0.075f}, {0,0,1}, {0,0}},
+			{{ 0.001f, -0.25f,  0.075f}, {0,0,1}, {1,0}},
+			{{ 0.001f,  0.25f,  0.075f}, {0,0,1}, {1,1}},
+			{{-0.001f,  0.25f,  0.075f}, {0,0,1}, {0,1}},
 			// Back face
-			{{-0.001f, -0.25f, -0.075f}, {0,0,0}, {0,0,-1}, {1,0}},
-			{{ 0.001f, -0.25f, -0.075f}, {0,0,0}, {0,0,-1}, {0,0}},
-			{{ 0.001f,  0.25f, -0.075f}, {0,0,0}, {0,0,-1}, {0,1}},
-			{{-0.001f,  0.25f, -0.075f}, {0,0,0}, {0,0,-1}, {1,1}},
+			{{-0.001f, -0.25f, -0.075f}, {0,0,-1}, {1,0}},
+			{{ 0.001f, -0.25f, -0.075f}, {0,0,-1}, {0,0}},
+			{{ 0.001f,  0.25f, -0.075f}, {0,0,-1}, {0,1}},
+			{{-0.001f,  0.25f, -0.075f}, {0,0,-1}, {1,1}},
 		};
 		indicesInstance = {
 			0, 1, 2, 2, 3, 0,  // Front face
@@ -0,0 +1,246 @@
+#include "Profiler.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using Utils::DebugLog;
+
+namespace Paddle {
+#if PADDLE_PROFILER
+	// Per thread, power of two. 32 bytes each: ~1 MB per thread, many
+	// seconds of zones at the rates the engine records them.
+	static constexpr uint64_t PROFILER_EVENTS_PER_THREAD = 1 << 15;
+
+	enum ProfileEventType : uint32_t {
+		PROFILE_EVENT_ZONE = 0,
+		PROFILE_EVENT_COUNTER
+	};
+
+	struct ProfileEvent {
+		const char* name;
+		int64_t timestamp; // Zone begin or counter sample, ns
+		int64_t value;     // Zone duration in ns or the counter value
+		ProfileEventType type;
+	};
+
+	// Written only by its thread; exporters read behind the published count.
+	struct ThreadBuffer {
+		std::unique_ptr<ProfileEvent[]> events{ new ProfileEvent[PROFILER_EVENTS_PER_THREAD] };
+		std::atomic<uint64_t> written{ 0 };
+		uint32_t threadId = 0;
+		std::string name; // Guarded by the registry mutex
+	};
+
+	// Buffers outlive their threads so a trace written after a worker
+	// exited still has its events.
+	struct ThreadRegistry {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> threads;
+	};
+
+	static ThreadRegistry& GetRegistry() {
+		static ThreadRegistry registry;
+		return registry;
+	}
+
+	static thread_local ThreadBuffer* currentThreadBuffer = nullptr;
+
+	// Locks once per thread, on its first event.
+	static ThreadBuffer& GetThreadBuffer() {
+		if(!currentThreadBuffer) {
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			registry.threads.emplace_back(new ThreadBuffer());
+			currentThreadBuffer = registry.threads.back().get();
+			currentThreadBuffer->threadId = static_cast<uint32_t>(registry.threads.size());
+			currentThreadBuffer->name = "Thread " + std::to_string(currentThreadBuffer->threadId);
+		}
+		return *currentThreadBuffer;
+	}
+
+	static void Record(const ProfileEvent& event) {
+		ThreadBuffer& buffer = GetThreadBuffer();
+		const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+		buffer.events[index & (PROFILER_EVENTS_PER_THREAD - 1)] = event;
+		buffer.written.store(index + 1, std::memory_order_release);
+	}
+
+	int64_t Profiler::Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Profiler::RecordZone(const char* name, int64_t begin, int64_t end) {
+		Record(ProfileEvent{ name, begin, end - begin, PROFILE_EVENT_ZONE });
+	}
+
+	void Profiler::RecordCounter(const char* name, int64_t value) {
+		Record(ProfileEvent{ name, Now(), value, PROFILE_EVENT_COUNTER });
+	}
+
+	void Profiler::SetThreadName(const std::string& name) {
+		ThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+		buffer.name = name;
+	}
+
+	//
+	// Export
+	//
+
+	struct ThreadEvents {
+		uint32_t threadId;
+		std::string name;
+		std::vector<ProfileEvent> events;
+	};
+
+	struct Profiler::TraceCapture {
+		std::vector<ThreadEvents> threads;
+		int64_t windowBegin; // Events that ended before this are left out
+	};
+
+	// Copies what the ring holds without stopping its writer. The writer may
+	// lap the copy, so anything it could have reached by the time the copy
+	// finished (including the slot it may be writing right now) is dropped.
+	static void CopyEvents(const ThreadBuffer& buffer, std::vector<ProfileEvent>& events) {
+		const uint64_t end = buffer.written.load(std::memory_order_acquire);
+		const uint64_t begin = end > PROFILER_EVENTS_PER_THREAD ? end - PROFILER_EVENTS_PER_THREAD : 0;
+
+		std::vector<ProfileEvent> copied;
+		copied.reserve(static_cast<size_t>(end - begin));
+		for(uint64_t i = begin; i < end; ++i)
+			copied.push_back(buffer.events[i & (PROFILER_EVENTS_PER_THREAD - 1)]);
+
+		const uint64_t after = buffer.written.load(std::memory_order_acquire);
+		const uint64_t firstIntact = after + 1 > PROFILER_EVENTS_PER_THREAD ? after + 1 - PROFILER_EVENTS_PER_THREAD : 0;
+		const uint64_t skip = firstIntact > begin ? std::min(firstIntact - begin, end - begin) : 0;
+
+		events.assign(copied.begin() + static_cast<ptrdiff_t>(skip), copied.end());
+	}
+
+	static std::string EscapeJson(const std::string& text) {
+		std::string escaped;
+		escaped.reserve(text.size());
+		for(char c : text) {
+			if(c == '"' || c == '\\') escaped += '\\';
+			if(static_cast<unsigned char>(c) < 0x20) continue;
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	std::shared_ptr<const Profiler::TraceCapture> Profiler::CaptureTrace(double windowSeconds) {
+		PROFILE_SCOPE("Capture trace");
+		auto capture = std::make_shared<TraceCapture>();
+
+		capture->windowBegin = windowSeconds > 0.0
+			? Now() - static_cast<int64_t>(windowSeconds * 1e9)
+			: std::numeric_limits<int64_t>::min();
+
+		// The lock only keeps new threads out, writers carry on.
+		auto& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		capture->threads.resize(registry.threads.size());
+		for(size_t i = 0; i < registry.threads.size(); ++i) {
+			capture->threads[i].threadId = registry.threads[i]->threadId;
+			capture->threads[i].name = registry.threads[i]->name;
+			CopyEvents(*registry.threads[i], capture->threads[i].events);
+		}
+		return capture;
+	}
+
+	bool Profiler::WriteTrace(const TraceCapture& capture, const std::string& path) {
+		PROFILE_SCOPE("Write trace");
+		const auto& threads = capture.threads;
+		const auto inWindow = [&capture](const ProfileEvent& event) {
+			const int64_t end = event.type == PROFILE_EVENT_ZONE ? event.timestamp + event.value : event.timestamp;
+			return end >= capture.windowBegin;
+		};
+
+		// Timestamps are relative to the first event written, which keeps
+		// them small enough for the viewers' double precision.
+		int64_t origin = std::numeric_limits<int64_t>::max();
+		for(const auto& thread : threads) {
+			for(const auto& event : thread.events) {
+				if(inWindow(event)) origin = std::min(origin, event.timestamp);
+			}
+		}
+		if(origin == std::numeric_limits<int64_t>::max()) origin = 0;
+
+		//
+		// Chrome trace event format
+		//
+		size_t eventCount = 0;
+		const bool written = Utils::WriteFileAtomically(path, [&](std::ofstream& file) {
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Paddle POV\"}}";
+
+			char line[512];
+			for(const auto& thread : threads) {
+				snprintf(line, sizeof(line), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+					thread.threadId, EscapeJson(thread.name).c_str());
+				file << line;
+
+				for(const auto& event : thread.events) {
+					if(!inWindow(event)) continue;
+
+					const double timestamp = static_cast<double>(event.timestamp - origin) / 1000.0;
+					const std::string name = EscapeJson(event.name);
+
+					if(event.type == PROFILE_EVENT_ZONE) {
+						snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+							name.c_str(), thread.threadId, timestamp, static_cast<double>(event.value) / 1000.0);
+					}
+					else {
+						snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+							name.c_str(), thread.threadId, timestamp, static_cast<long long>(event.value));
+					}
+					file << line;
+					++eventCount;
+				}
+			}
+
+			file << "\n]}\n";
+		});
+		if(!written) return false;
+
+		DebugLog("Wrote " + std::to_string(eventCount) + " profiler events from " +
+			std::to_string(threads.size()) + " threads to " + path);
+		return true;
+	}
+
+	bool Profiler::WriteTrace(const std::string& path, double windowSeconds) {
+		return WriteTrace(*CaptureTrace(windowSeconds), path);
+	}
+#else
+	int64_t Profiler::Now() { return 0; }
+	void Profiler::RecordZone(const char*, int64_t, int64_t) { }
+	void Profiler::RecordCounter(const char*, int64_t) { }
+	void Profiler::SetThreadName(const std::string&) { }
+
+	struct Profiler::TraceCapture { };
+
+	std::shared_ptr<const Profiler::TraceCapture> Profiler::CaptureTrace(double) {
+		DebugLog("Profiler is compiled out (PADDLE_PROFILER=0), nothing to capture");
+		return nullptr;
+	}
+
+	bool Profiler::WriteTrace(const TraceCapture&, const std::string&) {
+		return false;
+	}
+
+	bool Profiler::WriteTrace(const std::string& path, double) {
+		DebugLog("Profiler is compiled out (PADDLE_PROFILER=0), not writing " + path);
+		return false;
+	}
+#endif
+}
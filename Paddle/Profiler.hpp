@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Scoped CPU zones and counters, exported as Chrome trace JSON (open in
+// chrome://tracing or ui.perfetto.dev). Define PADDLE_PROFILER=0 to compile
+// every PROFILE_* macro out; CaptureTrace() and WriteTrace() then just
+// report that.
+#ifndef PADDLE_PROFILER
+#define PADDLE_PROFILER 1
+#endif
+
+namespace Paddle {
+	// Rolling window F9 dumps by default.
+	static constexpr double PROFILER_DEFAULT_WINDOW_SECONDS = 10.0;
+
+	// Each thread records into its own fixed ring, the newest events
+	// overwriting the oldest, so recording never locks or allocates after
+	// the thread's first event. Names must be string literals (or otherwise
+	// outlive the profiler), only the pointer is stored.
+	namespace Profiler {
+		// Nanoseconds on the clock zones are measured with.
+		int64_t Now();
+
+		void RecordZone(const char* name, int64_t begin, int64_t end);
+		void RecordCounter(const char* name, int64_t value);
+
+		// Shown as the thread's track name in the trace. Copied.
+		void SetThreadName(const std::string& name);
+
+		// Every thread's events, copied out of the rings.
+		struct TraceCapture;
+
+		// Copies what the rings still hold, only the last windowSeconds of it
+		// if windowSeconds > 0. Safe while other threads keep recording and
+		// cheap enough for a frame; formatting is left to WriteTrace(), which
+		// can run anywhere. Returns null if profiling is compiled out.
+		std::shared_ptr<const TraceCapture> CaptureTrace(double windowSeconds);
+
+		// Writes a capture as trace JSON. Returns false if the file can't be
+		// written.
+		bool WriteTrace(const TraceCapture& capture, const std::string& path);
+
+		// Both of the above on the calling thread. Returns false if the file
+		// can't be written or profiling is compiled out.
+		bool WriteTrace(const std::string& path, double windowSeconds);
+	}
+
+	class ProfileZone {
+	public:
+		explicit ProfileZone(const char* name) : name(name), begin(Profiler::Now()) { }
+		~ProfileZone() { Profiler::RecordZone(name, begin, Profiler::Now()); }
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		const char* name;
+		int64_t begin;
+	};
+}
+
+#if PADDLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing block.
+#define PROFILE_SCOPE(name) ::Paddle::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) ::Paddle::Profiler::RecordCounter(name, static_cast<int64_t>(value))
+#define PROFILE_THREAD(name) ::Paddle::Profiler::SetThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
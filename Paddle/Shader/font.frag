@@ -1,14 +1,26 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout(location = 0) in vec2 fragUV;
-layout(location = 1) in vec3 fragColor;
+layout(location = 1) in vec4 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
-layout(set = 0, binding = 1) uniform sampler2D fontSampler;
+// Bindless texture array, see Vk::BindlessDescriptors.
+layout(set = 0, binding = 2) uniform sampler2D textures[];
+
+layout(push_constant) uniform PushConstants {
+    mat4 proj;
+    uint textureIndex;
+} pc;
 
 void main() {
-    float alpha = texture(fontSampler, fragUV).r;
-    outColor = vec4(fragColor, alpha);
+    // Signed distance atlas: 0.5 is the glyph edge. Antialias over roughly
+    // one screen pixel whatever the text scale.
+    float dist = texture(textures[pc.textureIndex], fragUV).r;
+    float width = max(fwidth(dist), 0.0001);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+    outColor = vec4(fragColor.rgb, fragColor.a * alpha);
     if (alpha < 0.01)
         discard;
 }
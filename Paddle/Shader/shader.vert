@@ -1,8 +1,8 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec2 inUv;
+layout(location = 1) in vec2 inNormal; // Octahedral
 
 layout(location = 0) out vec3 fragColor;
 
@@ -13,17 +13,60 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 
 layout(push_constant) uniform PushConstants {
     mat4 model;
+    vec4 tint;
+    uint instanceBufferIndex;
 } pushConstants;
 
-const vec3 DIRECTION_TO_LIGHT = normalize(vec3(2.0, -2.0, 5.0));
-const float AMBIENT = 0.25;
+// Matches GpuInstance, indexed by gl_InstanceIndex in GPU-driven draws.
+struct Instance {
+    mat4 model;
+    vec4 tint;
+    vec4 boundingSphere;
+};
+
+layout(set = 0, binding = 1) readonly buffer InstanceBuffer {
+    Instance instances[];
+} instanceBuffers[];
+
+// Set per pipeline variant (MeshShading), the defaults match it.
+layout(constant_id = 0) const float LIGHT_DIRECTION_X = 2.0;
+layout(constant_id = 1) const float LIGHT_DIRECTION_Y = -2.0;
+layout(constant_id = 2) const float LIGHT_DIRECTION_Z = 5.0;
+layout(constant_id = 3) const float AMBIENT = 0.25;
+layout(constant_id = 4) const bool LIGHTING = true;
+// Model and tint come from the instance buffer instead of push constants.
+layout(constant_id = 5) const bool GPU_DRIVEN = false;
+
+vec3 octahedralDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * pushConstants.model * vec4(inPosition, 1.0);
+    mat4 model = pushConstants.model;
+    vec4 tint = pushConstants.tint;
+    if (GPU_DRIVEN) {
+        Instance instance = instanceBuffers[pushConstants.instanceBufferIndex].instances[gl_InstanceIndex];
+        model = instance.model;
+        tint = instance.tint;
+    }
+
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
+
+    if (!LIGHTING) {
+        fragColor = tint.rgb;
+        return;
+    }
+
+    // Folded into a constant when the pipeline is specialized.
+    vec3 directionToLight = normalize(vec3(LIGHT_DIRECTION_X, LIGHT_DIRECTION_Y, LIGHT_DIRECTION_Z));
 
-    vec3 normalWorldSpace = normalize(mat3(pushConstants.model) * inNormal);
-    float lightIntensity = max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+    vec3 normalWorldSpace = normalize(mat3(model) * octahedralDecode(inNormal));
+    float lightIntensity = max(dot(normalWorldSpace, directionToLight), 0);
     lightIntensity += AMBIENT;
 
-    fragColor = inColor * lightIntensity;
+    fragColor = tint.rgb * lightIntensity;
 }
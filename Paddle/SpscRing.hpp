@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Paddle {
+	// Fixed size single producer, single consumer ring. Both sides are wait
+	// free: pushing into a full ring or popping an empty one just fails.
+	// Capacity must be a power of two.
+	template <typename T, size_t Capacity>
+	class SpscRing {
+		static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+	public:
+		SpscRing() = default;
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		// === Producer ===
+		bool TryPush(const T& value) {
+			const size_t tail = tailIndex.load(std::memory_order_relaxed);
+			if(tail - headIndex.load(std::memory_order_acquire) == Capacity) return false;
+
+			slots[tail & (Capacity - 1)] = value;
+			tailIndex.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// === Consumer ===
+		bool TryPop(T& value) {
+			const size_t head = headIndex.load(std::memory_order_relaxed);
+			if(head == tailIndex.load(std::memory_order_acquire)) return false;
+
+			value = slots[head & (Capacity - 1)];
+			headIndex.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		std::array<T, Capacity> slots;
+
+		// Padding keeps the two indices on separate cache lines so the sides
+		// don't false share (alignas would over-align the owner, which plain
+		// new doesn't honour before C++17).
+		std::atomic<size_t> headIndex{ 0 };
+		char padding[64 - sizeof(std::atomic<size_t>)];
+		std::atomic<size_t> tailIndex{ 0 };
+	};
+}
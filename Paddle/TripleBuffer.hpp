@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Paddle {
+	// Single producer, single consumer hand-off of the latest value. The
+	// producer fills WriteBuffer() and calls Publish(); the consumer calls
+	// Consume() and reads ReadBuffer(). Neither side ever blocks, and the
+	// consumer always gets the most recent published value (older ones are
+	// simply overwritten).
+	template <typename T>
+	class TripleBuffer {
+	public:
+		TripleBuffer() = default;
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// === Producer ===
+		T& WriteBuffer() { return buffers[writeIndex]; }
+
+		void Publish() {
+			const uint32_t previous = middle.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+			writeIndex = previous & INDEX_MASK;
+		}
+
+		// === Consumer ===
+		// Returns true if a newer value was swapped in since the last call.
+		bool Consume() {
+			if(!(middle.load(std::memory_order_relaxed) & FRESH_BIT)) return false;
+
+			const uint32_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+			readIndex = previous & INDEX_MASK;
+			return true;
+		}
+
+		const T& ReadBuffer() const { return buffers[readIndex]; }
+
+	private:
+		static constexpr uint32_t FRESH_BIT  = 0x4;
+		static constexpr uint32_t INDEX_MASK = 0x3;
+
+		std::array<T, 3> buffers;
+		uint32_t writeIndex = 0;
+		uint32_t readIndex = 1;
+		std::atomic<uint32_t> middle{ 2 };
+	};
+}
@@ -1,5 +1,7 @@
 #include "Utils.hpp"
 
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <random>
 
@@ -9,6 +11,43 @@ void Utils::DebugLog(const std::string& message) {
 #endif
 }
 
+uint64_t Utils::HashBytes(const unsigned char* data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool Utils::WriteFileAtomically(const std::string& path, const std::function<void(std::ofstream& file)>& write) {
+	const std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+		try {
+			if(file) write(file);
+		}
+		catch(...) {
+			file.close();
+			std::remove(tempPath.c_str());
+			throw;
+		}
+
+		file.close();
+		if(!file) {
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	std::remove(path.c_str());
+	if(std::rename(tempPath.c_str(), path.c_str()) != 0) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
 bool Utils::RandomChance(float prob) {
 	std::random_device rd;
 	std::mt19937 gen(rd());
@@ -22,3 +61,13 @@ int Utils::RandomNumber(int start, int end) {
 	std::uniform_int_distribution<> dis(start, end);
 	return dis(gen);
 }
+
+static std::mt19937& ThreadGenerator() {
+	static thread_local std::mt19937 generator{ std::random_device{}() };
+	return generator;
+}
+
+float Utils::RandomFloat(float start, float end) {
+	std::uniform_real_distribution<float> dis(start, end);
+	return dis(ThreadGenerator());
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <vector>
 #include <string>
 
@@ -29,7 +33,21 @@ namespace Utils {
 
 	void DebugLog(const std::string& message);
 
+	// FNV-1a, plenty to notice an edited source asset behind a cache.
+	uint64_t HashBytes(const unsigned char* data, size_t size);
+
+	// Runs write against "<path>.tmp" and renames that over path once it is
+	// complete, so a crash or failed write never leaves a truncated file
+	// where the next reader would pick it up. Returns false (and removes the
+	// temp file) if anything failed; exceptions from write are rethrown
+	// after the same cleanup.
+	bool WriteFileAtomically(const std::string& path, const std::function<void(std::ofstream& file)>& write);
+
     bool RandomChance(float prob);
 
     int RandomNumber(int start, int end);
+
+    // Uniform in [start, end). Every thread draws from its own generator, so
+    // job threads neither share nor lock a global state.
+    float RandomFloat(float start, float end);
 }
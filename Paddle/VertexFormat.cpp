@@ -0,0 +1,164 @@
+#include "VertexFormat.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace Paddle {
+	struct FloatVertex {
+		glm::vec3 pos;
+		glm::vec2 normal;
+	};
+
+	struct PackedVertex {
+		uint16_t pos[4]; // Half floats, w is 1
+		uint32_t normal; // Two snorm16
+	};
+
+	static_assert(sizeof(FloatVertex) == 20, "FloatVertex must stay tightly packed");
+	static_assert(sizeof(PackedVertex) == 12, "PackedVertex must stay tightly packed");
+
+	struct VertexFormatInfo {
+		const char* name;
+		uint32_t stride;
+		VkFormat positionFormat;
+		uint32_t positionOffset;
+		VkFormat normalFormat;
+		uint32_t normalOffset;
+	};
+
+	// Indexed by VertexFormat.
+	static const VertexFormatInfo VERTEX_FORMAT_TABLE[VERTEX_FORMAT_COUNT] = {
+		{ "float",  sizeof(FloatVertex),  VK_FORMAT_R32G32B32_SFLOAT,    offsetof(FloatVertex, pos),  VK_FORMAT_R32G32_SFLOAT, offsetof(FloatVertex, normal) },
+		{ "packed", sizeof(PackedVertex), VK_FORMAT_R16G16B16A16_SFLOAT, offsetof(PackedVertex, pos), VK_FORMAT_R16G16_SNORM,  offsetof(PackedVertex, normal) },
+	};
+
+	static const VertexFormatInfo& GetInfo(VertexFormat format) {
+		if(format < 0 || format >= VERTEX_FORMAT_COUNT) throw std::runtime_error("unknown vertex format");
+		return VERTEX_FORMAT_TABLE[format];
+	}
+
+	const char* GetVertexFormatName(VertexFormat format) {
+		return GetInfo(format).name;
+	}
+
+	uint32_t GetVertexStride(VertexFormat format) {
+		return GetInfo(format).stride;
+	}
+
+	//
+	// Pipeline
+	//
+
+	VkVertexInputBindingDescription GetVertexBindingDescription(VertexFormat format) {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding   = 0;
+		bindingDescription.stride    = GetInfo(format).stride;
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> GetVertexAttributeDescriptions(VertexFormat format) {
+		const VertexFormatInfo& info = GetInfo(format);
+
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+		attributeDescriptions[0].binding  = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format   = info.positionFormat;
+		attributeDescriptions[0].offset   = info.positionOffset;
+
+		attributeDescriptions[1].binding  = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format   = info.normalFormat;
+		attributeDescriptions[1].offset   = info.normalOffset;
+
+		return attributeDescriptions;
+	}
+
+	//
+	// Packing
+	//
+
+	glm::vec2 OctahedralEncode(glm::vec3 normal) {
+		const float l1 = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+		if(l1 == 0.0f) return glm::vec2(0.0f); // Missing normal, decodes to +Z
+
+		normal /= l1;
+		glm::vec2 encoded(normal.x, normal.y);
+		if(normal.z < 0.0f) {
+			// Fold the lower hemisphere over the diagonals.
+			const float signX = encoded.x >= 0.0f ? 1.0f : -1.0f;
+			const float signY = encoded.y >= 0.0f ? 1.0f : -1.0f;
+			encoded = glm::vec2((1.0f - glm::abs(normal.y)) * signX, (1.0f - glm::abs(normal.x)) * signY);
+		}
+		return encoded;
+	}
+
+	glm::vec3 OctahedralDecode(glm::vec2 encoded) {
+		// Same as octahedralDecode() in shader.vert.
+		glm::vec3 normal(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+		const float t = glm::max(-normal.z, 0.0f);
+		normal.x += normal.x >= 0.0f ? -t : t;
+		normal.y += normal.y >= 0.0f ? -t : t;
+		return glm::normalize(normal);
+	}
+
+	std::vector<uint8_t> PackVertices(VertexFormat format, const std::vector<Vertex>& vertices) {
+		const uint32_t stride = GetVertexStride(format);
+		std::vector<uint8_t> packed(static_cast<size_t>(stride) * vertices.size());
+
+		for(size_t i = 0; i < vertices.size(); ++i) {
+			const Vertex& vertex = vertices[i];
+			uint8_t* out = packed.data() + i * stride;
+
+			if(format == VERTEX_FORMAT_PACKED) {
+				PackedVertex packedVertex;
+				packedVertex.pos[0] = glm::packHalf1x16(vertex.pos.x);
+				packedVertex.pos[1] = glm::packHalf1x16(vertex.pos.y);
+				packedVertex.pos[2] = glm::packHalf1x16(vertex.pos.z);
+				packedVertex.pos[3] = glm::packHalf1x16(1.0f);
+				packedVertex.normal = glm::packSnorm2x16(OctahedralEncode(vertex.normal));
+				memcpy(out, &packedVertex, sizeof(packedVertex));
+			}
+			else {
+				FloatVertex floatVertex;
+				floatVertex.pos = vertex.pos;
+				floatVertex.normal = OctahedralEncode(vertex.normal);
+				memcpy(out, &floatVertex, sizeof(floatVertex));
+			}
+		}
+
+		return packed;
+	}
+
+	std::vector<Vertex> UnpackVertices(VertexFormat format, const uint8_t* data, uint32_t vertexCount) {
+		const uint32_t stride = GetVertexStride(format);
+		std::vector<Vertex> vertices(vertexCount);
+
+		for(uint32_t i = 0; i < vertexCount; ++i) {
+			const uint8_t* in = data + static_cast<size_t>(i) * stride;
+			Vertex& vertex = vertices[i];
+
+			if(format == VERTEX_FORMAT_PACKED) {
+				PackedVertex packedVertex;
+				memcpy(&packedVertex, in, sizeof(packedVertex));
+				vertex.pos = glm::vec3(
+					glm::unpackHalf1x16(packedVertex.pos[0]),
+					glm::unpackHalf1x16(packedVertex.pos[1]),
+					glm::unpackHalf1x16(packedVertex.pos[2]));
+				vertex.normal = OctahedralDecode(glm::unpackSnorm2x16(packedVertex.normal));
+			}
+			else {
+				FloatVertex floatVertex;
+				memcpy(&floatVertex, in, sizeof(floatVertex));
+				vertex.pos = floatVertex.pos;
+				vertex.normal = OctahedralDecode(floatVertex.normal);
+			}
+			vertex.uv = glm::vec2(0.0f);
+		}
+
+		return vertices;
+	}
+}
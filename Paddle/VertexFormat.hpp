@@ -0,0 +1,40 @@
+#pragma once
+
+#include "GameVertex.hpp"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Paddle {
+	// GPU layouts for mesh vertices. Entities pack their Vertex list into the
+	// format the main pipeline was created with. Every format carries the same
+	// two attributes (position, octahedral normal), so shader.vert reads any
+	// of them unchanged.
+	enum VertexFormat {
+		VERTEX_FORMAT_FLOAT = 0, // 20 bytes: float3 position, float2 normal
+		VERTEX_FORMAT_PACKED,    // 12 bytes: half4 position, snorm16x2 normal
+		VERTEX_FORMAT_COUNT
+	};
+
+	const char* GetVertexFormatName(VertexFormat format);
+	uint32_t GetVertexStride(VertexFormat format);
+
+	// === Pipeline ===
+	VkVertexInputBindingDescription GetVertexBindingDescription(VertexFormat format);
+	std::vector<VkVertexInputAttributeDescription> GetVertexAttributeDescriptions(VertexFormat format);
+
+	// === Packing ===
+	std::vector<uint8_t> PackVertices(VertexFormat format, const std::vector<Vertex>& vertices);
+
+	// Inverse of PackVertices(), for data baked in a format other than the
+	// one the pipeline uses. UVs are not stored and come back as zero.
+	std::vector<Vertex> UnpackVertices(VertexFormat format, const uint8_t* data, uint32_t vertexCount);
+
+	// Unit vector to the [-1, 1] square, see "A Survey of Efficient
+	// Representations for Independent Unit Vectors" (Cigolle et al. 2014).
+	glm::vec2 OctahedralEncode(glm::vec3 normal);
+	glm::vec3 OctahedralDecode(glm::vec2 encoded);
+}
@@ -0,0 +1,183 @@
+#include "VkBindless.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "Utils.hpp"
+
+using Utils::DebugLog;
+
+namespace Vk {
+	BindlessDescriptors::BindlessDescriptors(Device& device) : device{ device } {
+		const VkPhysicalDeviceLimits& limits = device.properties.limits;
+		storageBufferCapacity = std::min({ BINDLESS_MAX_STORAGE_BUFFERS,
+			limits.maxPerStageDescriptorStorageBuffers, limits.maxDescriptorSetStorageBuffers });
+		textureCapacity = std::min({ BINDLESS_MAX_TEXTURES,
+			limits.maxPerStageDescriptorSampledImages, limits.maxPerStageDescriptorSamplers,
+			limits.maxDescriptorSetSampledImages, limits.maxDescriptorSetSamplers });
+
+		//
+		// Layout
+		//
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		bindings[0].binding         = BINDLESS_BINDING_UNIFORM;
+		bindings[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags      = VK_SHADER_STAGE_ALL;
+
+		bindings[1].binding         = BINDLESS_BINDING_STORAGE_BUFFERS;
+		bindings[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[1].descriptorCount = storageBufferCapacity;
+		bindings[1].stageFlags      = VK_SHADER_STAGE_ALL;
+
+		// Variable count has to be the last binding.
+		bindings[2].binding         = BINDLESS_BINDING_TEXTURES;
+		bindings[2].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[2].descriptorCount = textureCapacity;
+		bindings[2].stageFlags      = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// Slots past what was registered are never written, which is fine as
+		// long as no shader reads them.
+		const std::array<VkDescriptorBindingFlags, 3> bindingFlags = {
+			0,
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT
+		};
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+		bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount  = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext        = &bindingFlagsInfo;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings    = bindings.data();
+
+		if(vkCreateDescriptorSetLayout(device.device(), &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create bindless descriptor set layout");
+		}
+
+		//
+		// Pool, exactly one set
+		//
+		std::array<VkDescriptorPoolSize, 3> poolSizes{};
+		poolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[0].descriptorCount = 1;
+		poolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = storageBufferCapacity;
+		poolSizes[2].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[2].descriptorCount = textureCapacity;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes    = poolSizes.data();
+		poolInfo.maxSets       = 1;
+
+		if(vkCreateDescriptorPool(device.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create bindless descriptor pool");
+		}
+
+		//
+		// Set
+		//
+		VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+		variableCountInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+		variableCountInfo.descriptorSetCount = 1;
+		variableCountInfo.pDescriptorCounts  = &textureCapacity;
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.pNext              = &variableCountInfo;
+		allocInfo.descriptorPool     = pool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts        = &layout;
+
+		if(vkAllocateDescriptorSets(device.device(), &allocInfo, &set) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate bindless descriptor set");
+		}
+		device.SetObjectName((uint64_t)set, VK_OBJECT_TYPE_DESCRIPTOR_SET, "Bindless descriptor set");
+
+		DebugLog("Bindless set: " + std::to_string(storageBufferCapacity) + " storage buffers, " +
+			std::to_string(textureCapacity) + " textures");
+	}
+
+	BindlessDescriptors::~BindlessDescriptors() {
+		// Frees the set with it.
+		if(pool != VK_NULL_HANDLE)
+			vkDestroyDescriptorPool(device.device(), pool, nullptr);
+		if(layout != VK_NULL_HANDLE)
+			vkDestroyDescriptorSetLayout(device.device(), layout, nullptr);
+	}
+
+	void BindlessDescriptors::SetUniformBuffer(VkBuffer buffer, VkDeviceSize range) {
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range  = range;
+
+		VkWriteDescriptorSet write{};
+		write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet          = set;
+		write.dstBinding      = BINDLESS_BINDING_UNIFORM;
+		write.dstArrayElement = 0;
+		write.descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		write.descriptorCount = 1;
+		write.pBufferInfo     = &bufferInfo;
+
+		vkUpdateDescriptorSets(device.device(), 1, &write, 0, nullptr);
+	}
+
+	uint32_t BindlessDescriptors::AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+		if(storageBufferCount >= storageBufferCapacity) {
+			throw std::runtime_error("Bindless set is out of storage buffer slots");
+		}
+
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = offset;
+		bufferInfo.range  = range;
+
+		VkWriteDescriptorSet write{};
+		write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet          = set;
+		write.dstBinding      = BINDLESS_BINDING_STORAGE_BUFFERS;
+		write.dstArrayElement = storageBufferCount;
+		write.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.descriptorCount = 1;
+		write.pBufferInfo     = &bufferInfo;
+
+		vkUpdateDescriptorSets(device.device(), 1, &write, 0, nullptr);
+		return storageBufferCount++;
+	}
+
+	uint32_t BindlessDescriptors::AddTexture(VkImageView imageView, VkSampler sampler) {
+		if(textureCount >= textureCapacity) {
+			throw std::runtime_error("Bindless set is out of texture slots");
+		}
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView   = imageView;
+		imageInfo.sampler     = sampler;
+
+		VkWriteDescriptorSet write{};
+		write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet          = set;
+		write.dstBinding      = BINDLESS_BINDING_TEXTURES;
+		write.dstArrayElement = textureCount;
+		write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.descriptorCount = 1;
+		write.pImageInfo      = &imageInfo;
+
+		vkUpdateDescriptorSets(device.device(), 1, &write, 0, nullptr);
+		return textureCount++;
+	}
+
+	void BindlessDescriptors::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout) {
+		vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &set, 0, nullptr);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "VkDevice.hpp"
+
+#include <cstdint>
+
+namespace Vk {
+	// Binding numbers of the global set, shared with the shaders.
+	enum BindlessBinding {
+		BINDLESS_BINDING_UNIFORM = 0,         // uniform, frame globals (camera)
+		BINDLESS_BINDING_STORAGE_BUFFERS = 1, // buffer[], partially bound
+		BINDLESS_BINDING_TEXTURES = 2,        // sampler2D[], variable count, partially bound
+	};
+
+	// Upper bounds, clamped further by the device limits.
+	static constexpr uint32_t BINDLESS_MAX_STORAGE_BUFFERS = 64;
+	static constexpr uint32_t BINDLESS_MAX_TEXTURES = 1024;
+
+	// The one descriptor set every pipeline uses as set 0. Resources are
+	// registered once and then referred to by the index they got, passed in
+	// push constants or instance data, so a command buffer binds the set
+	// once instead of per draw. The pool is sized from the capacities above,
+	// there is nothing to guess per feature.
+	//
+	// Register everything before recording command buffers that bind the
+	// set: without update-after-bind, writing it invalidates them.
+	class BindlessDescriptors {
+	public:
+		BindlessDescriptors(Device& device);
+		~BindlessDescriptors();
+
+		BindlessDescriptors(const BindlessDescriptors&) = delete;
+		BindlessDescriptors& operator=(const BindlessDescriptors&) = delete;
+
+		void SetUniformBuffer(VkBuffer buffer, VkDeviceSize range);
+
+		// Return the index to use in shaders. Throws once the set is full.
+		uint32_t AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+		uint32_t AddTexture(VkImageView imageView, VkSampler sampler);
+
+		void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout);
+
+		VkDescriptorSetLayout GetLayout() const { return layout; }
+
+	private:
+		Device& device;
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		VkDescriptorSet set = VK_NULL_HANDLE;
+
+		uint32_t storageBufferCapacity = 0;
+		uint32_t textureCapacity = 0;
+		uint32_t storageBufferCount = 0;
+		uint32_t textureCount = 0;
+	};
+}
@@ -6,6 +6,7 @@
 #include <stdexcept>
 
 #include "Utils.hpp"
+#include "Profiler.hpp"
 
 using Utils::DebugLog;
 
@@ -83,7 +84,8 @@ namespace Vk {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		// 1.2 for descriptor indexing (bindless set) in core.
+		appInfo.apiVersion = VK_API_VERSION_1_2;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -158,9 +160,28 @@ namespace Vk {
 
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		deviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+
+		// What BindlessDescriptors relies on, checked by isDeviceSuitable().
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.descriptorIndexing = VK_TRUE;
+		vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+		vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+		vulkan12Features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+
+		// Optional, the GPU-driven path falls back to CPU draws without it.
+		indirectCountSupported = supportsIndirectCount(physicalDevice);
+		if (indirectCountSupported) {
+			deviceFeatures.multiDrawIndirect = VK_TRUE;
+			deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+			vulkan12Features.drawIndirectCount = VK_TRUE;
+		}
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &vulkan12Features;
 
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -218,7 +239,41 @@ namespace Vk {
 		vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
 		return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-			supportedFeatures.samplerAnisotropy;
+			supportedFeatures.samplerAnisotropy && supportedFeatures.shaderSampledImageArrayDynamicIndexing &&
+			supportedFeatures.shaderStorageBufferArrayDynamicIndexing && supportsDescriptorIndexing(device);
+	}
+
+	bool Device::supportsDescriptorIndexing(VkPhysicalDevice device) {
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+		if (deviceProperties.apiVersion < VK_API_VERSION_1_2) return false;
+
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 features2 = {};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+
+		return vulkan12Features.descriptorIndexing &&
+			vulkan12Features.runtimeDescriptorArray &&
+			vulkan12Features.descriptorBindingPartiallyBound &&
+			vulkan12Features.descriptorBindingVariableDescriptorCount;
+	}
+
+	bool Device::supportsIndirectCount(VkPhysicalDevice device) {
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 features2 = {};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+
+		return features2.features.multiDrawIndirect &&
+			features2.features.drawIndirectFirstInstance &&
+			vulkan12Features.drawIndirectCount;
 	}
 
 	void Device::populateDebugMessengerCreateInfo(
@@ -402,6 +457,22 @@ namespace Vk {
 		}
 	}
 
+	VkCommandPool Device::CreateCommandPool(VkCommandPoolCreateFlags flags)
+	{
+		QueueFamilyIndices queueFamilyIndices = findPhysicalQueueFamilies();
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
+		poolInfo.flags = flags;
+
+		VkCommandPool pool;
+		if (vkCreateCommandPool(device_, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create command pool!");
+		}
+		return pool;
+	}
+
 	VkFormat Device::findSupportedFormat(
 		const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
 		for (VkFormat format : candidates) {
@@ -572,6 +643,7 @@ namespace Vk {
 	}
 
 	void Device::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
+		PROFILE_SCOPE("Single time commands");
 		vkEndCommandBuffer(commandBuffer);
 
 		VkSubmitInfo submitInfo{};
@@ -111,6 +111,13 @@ namespace Vk
 
 		void SetObjectName(uint64_t handle, VkObjectType type, const std::string& name);
 
+		// Extra pools for threads that record on their own; a pool must only
+		// ever be used by one thread at a time. Caller owns the pool.
+		VkCommandPool CreateCommandPool(VkCommandPoolCreateFlags flags);
+
+		// vkCmdDrawIndexedIndirectCount with multi draw and firstInstance.
+		bool supportsIndirectCount() const { return indirectCountSupported; }
+
 		VkPhysicalDeviceProperties properties;
 
 	private:
@@ -123,6 +130,8 @@ namespace Vk
 
 		// helper functions
 		bool isDeviceSuitable(VkPhysicalDevice device);
+		bool supportsDescriptorIndexing(VkPhysicalDevice device);
+		bool supportsIndirectCount(VkPhysicalDevice device);
 		std::vector<const char*> getRequiredExtensions();
 		bool checkValidationLayerSupport();
 		QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device);
@@ -136,6 +145,7 @@ namespace Vk
 		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
 		Window& window;
 		VkCommandPool commandPool;
+		bool indirectCountSupported = false;
 
 		VkDevice device_;
 		VkSurfaceKHR surface_;
@@ -1,8 +1,9 @@
 #include "VkPipeline.hpp"
 
-#include <fstream>
 #include <stdexcept>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 #include "Utils.hpp"
 
@@ -10,8 +11,55 @@ using Utils::DebugLog;
 
 namespace Vk
 {
-	Pipeline::Pipeline(Device& device, const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo) : device{ device } {
-		CreateGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+	void SpecializationConstants::Set(uint32_t constantId, float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		SetBits(constantId, bits);
+	}
+
+	void SpecializationConstants::Set(uint32_t constantId, int32_t value) {
+		SetBits(constantId, static_cast<uint32_t>(value));
+	}
+
+	void SpecializationConstants::Set(uint32_t constantId, bool value) {
+		SetBits(constantId, value ? VK_TRUE : VK_FALSE);
+	}
+
+	void SpecializationConstants::SetBits(uint32_t constantId, uint32_t bits) {
+		auto it = std::lower_bound(entries.begin(), entries.end(), constantId,
+			[](const VkSpecializationMapEntry& entry, uint32_t id) { return entry.constantID < id; });
+		const size_t index = static_cast<size_t>(it - entries.begin());
+
+		if(it != entries.end() && it->constantID == constantId) {
+			data[index] = bits;
+			return;
+		}
+
+		entries.insert(it, VkSpecializationMapEntry{ constantId, 0, sizeof(uint32_t) });
+		data.insert(data.begin() + index, bits);
+		for(size_t i = index; i < entries.size(); ++i)
+			entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+	}
+
+	VkSpecializationInfo SpecializationConstants::GetInfo() const {
+		VkSpecializationInfo info{};
+		info.mapEntryCount = static_cast<uint32_t>(entries.size());
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size() * sizeof(uint32_t);
+		info.pData = data.data();
+		return info;
+	}
+
+	Pipeline::Pipeline(Device& device, const Paddle::AssetFileSystem& files, const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo) : device{ device } {
+		Paddle::AssetFile vertCode, fragCode;
+		OpenFile(files, vertFilePath, vertCode);
+		OpenFile(files, fragFilePath, fragCode);
+		CreateGraphicsPipeline(vertFilePath, vertCode, fragFilePath, fragCode, configInfo);
+	}
+
+	Pipeline::Pipeline(Device& device, const std::string vertFilePath, const Paddle::AssetFile& vertCode,
+	                   const std::string fragFilePath, const Paddle::AssetFile& fragCode, const PipelineConfigInfo& configInfo) : device{ device } {
+		CreateGraphicsPipeline(vertFilePath, vertCode, fragFilePath, fragCode, configInfo);
 	}
 
 	Pipeline::~Pipeline()
@@ -31,41 +79,47 @@ namespace Vk
 	}
 
 
+	static void CreateShaderModule(Device& device, const Paddle::AssetFile& code, VkShaderModule* shaderModule)
+	{
+		// Embedded arrays, pack entries and mappings are all at least 4 byte
+		// aligned, as pCode requires.
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = code.Size();
+		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.Data());
+		if (vkCreateShaderModule(device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create shader module");
+		}
+	}
+
 	void Pipeline::bind(VkCommandBuffer commandBuffer) {
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 	}
 
-	std::vector<char> Pipeline::ReadFile(const std::string& filePath)
+	void Pipeline::OpenFile(const Paddle::AssetFileSystem& files, const std::string& filePath, Paddle::AssetFile& file)
 	{
-		std::ifstream file{ filePath, std::ios::ate | std::ios::binary };
-		if (!file.is_open())
+		if (!files.Open(filePath, file))
 		{
 			throw std::runtime_error("Failed to open file: " + filePath);
 		}
-
-		size_t fileSize = static_cast<size_t>(file.tellg());
-		std::vector<char> buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
-		return buffer;
 	}
 
-	void Pipeline::CreateGraphicsPipeline(const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo)
+	void Pipeline::CreateGraphicsPipeline(const std::string vertFilePath, const Paddle::AssetFile& vertCode,
+	                                      const std::string fragFilePath, const Paddle::AssetFile& fragCode, const PipelineConfigInfo& configInfo)
 	{
 		assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
 		assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline: no renderPass provided in configInfo");
-		auto vertCode = ReadFile(vertFilePath);
-		auto fragCode = ReadFile(fragFilePath);
 
-		CreateShaderModule(vertCode, &vertShaderModule);
+		CreateShaderModule(device, vertCode, &vertShaderModule);
 		device.SetObjectName((uint64_t)vertShaderModule, VK_OBJECT_TYPE_SHADER_MODULE, vertFilePath + " vertShaderModule");
 		
-		CreateShaderModule(fragCode, &fragShaderModule);
+		CreateShaderModule(device, fragCode, &fragShaderModule);
 		device.SetObjectName((uint64_t)fragShaderModule, VK_OBJECT_TYPE_SHADER_MODULE, fragFilePath + " fragShaderModule");
 
+		const VkSpecializationInfo specializationInfo = configInfo.specialization.GetInfo();
+		const VkSpecializationInfo* pSpecializationInfo = configInfo.specialization.Empty() ? nullptr : &specializationInfo;
+
 		VkPipelineShaderStageCreateInfo shaderStages[2];
 		shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -73,7 +127,7 @@ namespace Vk
 		shaderStages[0].pName = "main";
 		shaderStages[0].flags = 0;
 		shaderStages[0].pNext = nullptr;
-		shaderStages[0].pSpecializationInfo = nullptr;
+		shaderStages[0].pSpecializationInfo = pSpecializationInfo;
 
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -81,7 +135,7 @@ namespace Vk
 		shaderStages[1].pName = "main";
 		shaderStages[1].flags = 0;
 		shaderStages[1].pNext = nullptr;
-		shaderStages[1].pSpecializationInfo = nullptr;
+		shaderStages[1].pSpecializationInfo = pSpecializationInfo;
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = configInfo.vertexInputInfo;
 		if (vertexInputInfo.sType == 0) {
@@ -126,18 +180,45 @@ namespace Vk
 		}
 	}
 
-	void Pipeline::CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule)
-	{
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-		if (vkCreateShaderModule(device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
+	ComputePipeline::ComputePipeline(Device& device, const std::string& filePath, const Paddle::AssetFile& code,
+	                                 VkPipelineLayout pipelineLayout, const SpecializationConstants& specialization) : device{ device } {
+		assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided");
+
+		CreateShaderModule(device, code, &shaderModule);
+		device.SetObjectName((uint64_t)shaderModule, VK_OBJECT_TYPE_SHADER_MODULE, filePath + " shaderModule");
+
+		const VkSpecializationInfo specializationInfo = specialization.GetInfo();
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.stage.pSpecializationInfo = specialization.Empty() ? nullptr : &specializationInfo;
+		pipelineInfo.layout = pipelineLayout;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		if (vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS)
 		{
-			throw std::runtime_error("Failed to create shader module");
+			throw std::runtime_error("Failed to create compute pipeline");
 		}
 	}
 
+	ComputePipeline::~ComputePipeline()
+	{
+		DebugLog("Destroying compute pipeline");
+		if (computePipeline != VK_NULL_HANDLE)
+			vkDestroyPipeline(device.device(), computePipeline, nullptr);
+		if (shaderModule != VK_NULL_HANDLE)
+			vkDestroyShaderModule(device.device(), shaderModule, nullptr);
+	}
+
+	void ComputePipeline::bind(VkCommandBuffer commandBuffer) {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+	}
+
 	PipelineConfigInfo Pipeline::DefaultPipelineConfigInfo(uint32_t width, uint32_t height)
 	{
 		PipelineConfigInfo configInfo{};
@@ -3,10 +3,35 @@
 //#include <vulkan/vulkan.h>
 
 #include "VkDevice.hpp"
+#include "AssetPack.hpp"
 #include <string>
 #include <vector>
 
 namespace Vk {
+    // Values for the shaders' layout(constant_id = N) constants. Shared by
+    // both stages, a stage simply ignores ids it doesn't declare. Every
+    // constant is 4 bytes (bools as VkBool32) and kept sorted by id, so the
+    // same values always give the same bytes no matter the Set() order.
+    class SpecializationConstants {
+    public:
+        void Set(uint32_t constantId, float value);
+        void Set(uint32_t constantId, int32_t value);
+        void Set(uint32_t constantId, bool value);
+
+        bool Empty() const { return entries.empty(); }
+        const std::vector<VkSpecializationMapEntry>& Entries() const { return entries; }
+        const std::vector<uint32_t>& Data() const { return data; }
+
+        // Points into this object, valid for as long as it isn't modified.
+        VkSpecializationInfo GetInfo() const;
+
+    private:
+        void SetBits(uint32_t constantId, uint32_t bits);
+
+        std::vector<VkSpecializationMapEntry> entries;
+        std::vector<uint32_t> data;
+    };
+
 	struct PipelineConfigInfo {
         VkViewport viewport;
         VkRect2D scissor;
@@ -20,11 +45,15 @@ namespace Vk {
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+        SpecializationConstants specialization;
     };
 
     class Pipeline {
     public:
-        Pipeline(Device& device, const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo);
+        Pipeline(Device& device, const Paddle::AssetFileSystem& files, const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo);
+        // SPIR-V already opened; the paths are only used to name the modules.
+        Pipeline(Device& device, const std::string vertFilePath, const Paddle::AssetFile& vertCode,
+                 const std::string fragFilePath, const Paddle::AssetFile& fragCode, const PipelineConfigInfo& configInfo);
 		~Pipeline();
 
         Pipeline(const Pipeline&) = delete;
@@ -40,8 +69,26 @@ namespace Vk {
         VkShaderModule vertShaderModule;
         VkShaderModule fragShaderModule;
 
-        static std::vector<char> ReadFile(const std::string& filePath);
-        void CreateGraphicsPipeline(const std::string vertFilePath, const std::string fragFilePath, const PipelineConfigInfo& configInfo);
-        void CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+        static void OpenFile(const Paddle::AssetFileSystem& files, const std::string& filePath, Paddle::AssetFile& file);
+        void CreateGraphicsPipeline(const std::string vertFilePath, const Paddle::AssetFile& vertCode,
+                                    const std::string fragFilePath, const Paddle::AssetFile& fragCode, const PipelineConfigInfo& configInfo);
+    };
+
+    class ComputePipeline {
+    public:
+        // SPIR-V already opened; the path is only used to name the module.
+        ComputePipeline(Device& device, const std::string& filePath, const Paddle::AssetFile& code,
+                        VkPipelineLayout pipelineLayout, const SpecializationConstants& specialization);
+        ~ComputePipeline();
+
+        ComputePipeline(const ComputePipeline&) = delete;
+        ComputePipeline& operator=(const ComputePipeline&) = delete;
+
+        void bind(VkCommandBuffer commandBuffer);
+
+    private:
+        Device& device;
+        VkPipeline computePipeline = VK_NULL_HANDLE;
+        VkShaderModule shaderModule = VK_NULL_HANDLE;
     };
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <stdexcept>
 
 #include "Utils.hpp"
+#include "Profiler.hpp"
 
 using Utils::DebugLog;
 
@@ -55,6 +56,7 @@ namespace Vk
     }
 
     VkResult SwapChain::acquireNextImage(uint32_t* imageIndex) {
+        PROFILE_SCOPE("Acquire image");
         vkWaitForFences(
             device.device(),
             1,
@@ -73,11 +75,19 @@ namespace Vk
         return result;
     }
 
+    // Blocks until the last submission that rendered to this image is done,
+    // so its command buffers can be re-recorded. Call after acquireNextImage.
+    void SwapChain::waitForImage(uint32_t imageIndex) {
+        if (imagesInFlight[imageIndex] != VK_NULL_HANDLE) {
+            PROFILE_SCOPE("Wait for image");
+            vkWaitForFences(device.device(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        }
+    }
+
     VkResult SwapChain::submitCommandBuffers(
         const VkCommandBuffer* buffers, uint32_t* imageIndex) {
-        if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-            vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-        }
+        PROFILE_SCOPE("Submit and present");
+        waitForImage(*imageIndex);
         imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
 
         VkSubmitInfo submitInfo = {};
@@ -114,7 +124,11 @@ namespace Vk
 
         presentInfo.pImageIndices = imageIndex;
 
-        auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+        VkResult result;
+        {
+            PROFILE_SCOPE("Present");
+            result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+        }
 
         currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
@@ -412,7 +426,10 @@ namespace Vk
     }
 
     void SwapChain::recreate() {
-        vkDeviceWaitIdle(device.device());
+        {
+            PROFILE_SCOPE("Device wait idle");
+            vkDeviceWaitIdle(device.device());
+        }
 
         for (auto framebuffer : swapChainFramebuffers) {
             vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
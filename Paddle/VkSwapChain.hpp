@@ -26,6 +26,7 @@ namespace Vk {
         VkExtent2D getSwapChainExtent() { return swapChainExtent; }
         uint32_t width() { return swapChainExtent.width; }
         uint32_t height() { return swapChainExtent.height; }
+        size_t getCurrentFrame() { return currentFrame; }
 
         float extentAspectRatio() {
             return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
@@ -33,6 +34,7 @@ namespace Vk {
         VkFormat findDepthFormat();
 
         VkResult acquireNextImage(uint32_t* imageIndex);
+        void waitForImage(uint32_t imageIndex);
         VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
         void recreate();
         void setWindowExtent(VkExtent2D extent) { windowExtent = extent; }
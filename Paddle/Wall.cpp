@@ -5,17 +5,18 @@
 namespace Paddle {
 	Wall::Wall(GameContext& context, float x, float y, float z, glm::vec3 halfExtents)
 		: GameEntity(context), halfExtents(halfExtents) {
+		tintColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 		verticesInstance = {
 			// Front face
-			{{-10.0f, -0.1f,  1.0f}, {0,0,0}, {0,0,1}, {0,0}},
-			{{ 10.0f, -0.1f,  1.0f}, {0,0,0}, {0,0,1}, {1,0}},
-			{{ 10.0f,  0.1f,  1.0f}, {0,0,0}, {0,0,1}, {1,1}},
-			{{-10.0f,  0.1f,  1.0f}, {0,0,0}, {0,0,1}, {0,1}},
+			{{-10.0f, -0.1f,  1.0f}, {0,0,1}, {0,0}},
+			{{ 10.0f, -0.1f,  1.0f}, {0,0,1}, {1,0}},
+			{{ 10.0f,  0.1f,  1.0f}, {0,0,1}, {1,1}},
+			{{-10.0f,  0.1f,  1.0f}, {0,0,1}, {0,1}},
 			// Back face
-			{{-10.0f, -0.1f, -1.0f}, {0,0,0}, {0,0,-1}, {1,0}},
-			{{ 10.0f, -0.1f, -1.0f}, {0,0,0}, {0,0,-1}, {0,0}},
-			{{ 10.0f,  0.1f, -1.0f}, {0,0,0}, {0,0,-1}, {0,1}},
-			{{-10.0f,  0.1f, -1.0f}, {0,0,0}, {0,0,-1}, {1,1}},
+			{{-10.0f, -0.1f, -1.0f}, {0,0,-1}, {1,0}},
+			{{ 10.0f, -0.1f, -1.0f}, {0,0,-1}, {0,0}},
+			{{ 10.0f,  0.1f, -1.0f}, {0,0,-1}, {0,1}},
+			{{-10.0f,  0.1f, -1.0f}, {0,0,-1}, {1,1}},
 		};
 		indicesInstance = {
 			0, 1, 2, 2, 3, 0,  // Front face
@@ -1,6 +1,9 @@
-REM Compile all shaders
+REM Compile all shaders to loose .spv files. The build already embeds them in
+REM the executable; these are only picked up when running with --loose-assets.
 %VULKAN_SDK%\Bin\glslc.exe .\Shader\shader.vert -o .\Shader\shader.vert.spv
 %VULKAN_SDK%\Bin\glslc.exe .\Shader\shader.frag -o .\Shader\shader.frag.spv
 
 %VULKAN_SDK%\Bin\glslc.exe .\Shader\font.vert -o .\Shader\font.vert.spv
 %VULKAN_SDK%\Bin\glslc.exe .\Shader\font.frag -o .\Shader\font.frag.spv
+
+%VULKAN_SDK%\Bin\glslc.exe .\Shader\cull.comp -o .\Shader\cull.comp.spv
\ No newline at end of file
@@ -1,10 +1,46 @@
 #include "Game.hpp"
+#include "AudioBenchmark.hpp"
+#include "AssetPack.hpp"
+#include "MeshFile.hpp"
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
-int main()
+int main(int argc, char** argv)
 {
-	Paddle::Game game;
+	Paddle::GameOptions options;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--audio-bench") == 0) return Paddle::RunAudioBenchmark();
+		else if (strcmp(argv[i], "--convert-mesh") == 0) {
+			if (i + 2 >= argc) {
+				std::cerr << "Usage: --convert-mesh <input.obj> <output.pmesh>" << std::endl;
+				return EXIT_FAILURE;
+			}
+			return Paddle::RunMeshConverter(argv[i + 1], argv[i + 2]);
+		}
+		else if (strcmp(argv[i], "--build-pack") == 0) {
+			if (i + 2 >= argc) {
+				std::cerr << "Usage: --build-pack <manifest> <output.pak>" << std::endl;
+				return EXIT_FAILURE;
+			}
+			return Paddle::RunPackBuilder(argv[i + 1], argv[i + 2]);
+		}
+		else if (strcmp(argv[i], "--preload-bgm") == 0) options.audio.bgmLoadMode = Paddle::BGM_LOAD_PRELOAD;
+		else if (strcmp(argv[i], "--low-latency-audio") == 0) options.audio.lowLatency = true;
+		else if (strncmp(argv[i], "--audio-period-frames=", 22) == 0) options.audio.periodSizeInFrames = static_cast<uint32_t>(atoi(argv[i] + 22));
+		else if (strncmp(argv[i], "--audio-periods=", 16) == 0) options.audio.periodCount = static_cast<uint32_t>(atoi(argv[i] + 16));
+		else if (strcmp(argv[i], "--float-vertices") == 0) options.vertexFormat = Paddle::VERTEX_FORMAT_FLOAT;
+		else if (strcmp(argv[i], "--loose-assets") == 0) options.preferLooseAssets = true;
+		else if (strcmp(argv[i], "--unlit") == 0) options.shading.lighting = false;
+		else if (strncmp(argv[i], "--ambient=", 10) == 0) options.shading.ambient = static_cast<float>(atof(argv[i] + 10));
+		else if (strcmp(argv[i], "--cpu-culling") == 0) options.gpuDriven = false;
+		else if (strncmp(argv[i], "--trace=", 8) == 0) options.tracePath = argv[i] + 8;
+		else if (strncmp(argv[i], "--trace-window=", 15) == 0) options.traceWindowSeconds = atof(argv[i] + 15);
+		else std::cerr << "Unknown option: " << argv[i] << std::endl;
+	}
+
+	Paddle::Game game(options);
 
 	try {
 		game.run();